@@ -0,0 +1,155 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "perf_counters.hpp"
+
+/// @brief A minimal benchmark harness for the dlutils benchmarks
+///
+/// Each benchmark runs its body repeatedly until a minimum time has elapsed
+/// and reports the mean time per operation. It has no dependencies, so the
+/// benchmarks build wherever the tests build.
+namespace dlutils::bench {
+
+/// @brief Prevent the compiler from optimizing a value away
+template <class T> inline void DoNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// @brief Prevent the compiler from caching memory across this point
+inline void ClobberMemory() { asm volatile("" : : : "memory"); }
+
+/// @brief Runs benchmarks and prints one result line per benchmark
+class Runner {
+public:
+  /// @brief Constructor
+  ///
+  /// Recognizes "--min-time=<seconds>", "--filter=<substring>" and
+  /// "--perf". With --perf, Run() also reports the instructions and branch
+  /// misses per operation (n/a if the counters cannot be opened).
+  ///
+  /// @param argc The argument count of main
+  /// @param argv The arguments of main
+  Runner(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+      if (std::strncmp(argv[i], "--min-time=", 11) == 0) {
+        minTime_ = std::chrono::duration<double>(std::atof(argv[i] + 11));
+      } else if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+        filter_ = argv[i] + 9;
+      } else if (std::strcmp(argv[i], "--perf") == 0) {
+        perf_ = std::make_unique<PerfCounters>();
+      }
+    }
+    std::printf("%-56s %14s %14s", "benchmark", "ns/op", "ops/s");
+    if (perf_) {
+      std::printf(" %14s %14s", "instr/op", "br-miss/op");
+    }
+    std::printf("\n");
+  }
+
+  /// @brief Run a benchmark whose body performs ops operations
+  /// @param name The name of the benchmark
+  /// @param ops The number of operations performed by one call of fn
+  /// @param fn The benchmark body
+  template <class Fn> void Run(const std::string &name, uint64_t ops, Fn fn) {
+    RunTimed(name, ops, [this, &fn]() {
+      if (perf_) {
+        perf_->Start();
+      }
+      auto start = Clock::now();
+      fn();
+      auto elapsed = Clock::now() - start;
+      if (perf_) {
+        PerfCounters::Values values = perf_->Stop();
+        counted_.instructions += values.instructions;
+        counted_.branchMisses += values.branchMisses;
+        countedRuns_++;
+      }
+      return elapsed;
+    });
+  }
+
+  /// @brief Run a benchmark whose body times itself
+  ///
+  /// Use this when each iteration needs an untimed setup step. The hardware
+  /// counters of --perf are not collected for such benchmarks.
+  ///
+  /// @param name The name of the benchmark
+  /// @param ops The number of operations performed by one call of fn
+  /// @param fn The benchmark body, returning the duration of the timed part
+  template <class Fn>
+  void RunTimed(const std::string &name, uint64_t ops, Fn fn) {
+    if (name.find(filter_) == std::string::npos) {
+      return;
+    }
+    fn(); // warm up
+    counted_ = PerfCounters::Values{};
+    countedRuns_ = 0;
+    Clock::duration total{0};
+    uint64_t iterations = 0;
+    auto deadline = Clock::now() + minTime_;
+    while (iterations == 0 || Clock::now() < deadline) {
+      total += fn();
+      iterations++;
+    }
+    double ns = std::chrono::duration<double, std::nano>(total).count() /
+                static_cast<double>(iterations * ops);
+    std::printf("%-56s %14.2f %14.0f", name.c_str(), ns, 1e9 / ns);
+    if (perf_) {
+      PrintCounters(iterations * ops);
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  /// @brief Print the counters collected since the last warm-up
+  void PrintCounters(uint64_t ops) const {
+    if (!perf_->IsOpen() || countedRuns_ == 0) {
+      std::printf(" %14s %14s", "n/a", "n/a");
+      return;
+    }
+    double n = static_cast<double>(ops);
+    std::printf(" %14.2f %14.4f",
+                static_cast<double>(counted_.instructions) / n,
+                static_cast<double>(counted_.branchMisses) / n);
+  }
+
+  std::chrono::duration<double> minTime_{0.2}; ///< Minimum time per benchmark
+  std::string filter_; ///< Only run benchmarks whose name contains this
+  std::unique_ptr<PerfCounters> perf_; ///< The counters of --perf, if given
+  PerfCounters::Values counted_;       ///< The counters of the current run
+  uint64_t countedRuns_ = 0; ///< The counted iterations of the current run
+};
+
+} // namespace dlutils::bench
@@ -0,0 +1,138 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Call overhead of the DlFun dispatch strategies, per argument shape: a
+// direct call into a statically linked copy of the targets, a raw function
+// pointer, a std::function (how DlFun used to store its target), DlFun,
+// DlUncheckedFun and a bound DlLazyFun.
+//
+// The targets (DLUTILS_DISPATCH_LIB) are built from dispatch_targets.c. Run
+// with --perf to also report the instructions and branch misses per call.
+
+#include "bench.hpp"
+#include "dlutils/dlutils.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+extern "C" {
+int dlutils_direct_zero(void);
+int dlutils_direct_one(int x);
+double dlutils_direct_two_double(double a, double b);
+int dlutils_direct_update(void *ctx, const void *data, size_t len);
+}
+
+namespace dlutils {
+
+// Exposes the protected DlLibBase API to the benchmarks
+class BenchLib : public DlLibBase {
+public:
+  explicit BenchLib(std::string_view lib) : DlLibBase(lib) {}
+
+  bool Open() { return SelfDlOpen(); }
+
+  template <class R, class... Args>
+  bool Sym(std::string_view funName, DlFun<R, Args...> &outFun) {
+    return SelfDlSym(funName, outFun);
+  }
+
+  template <class R, class... Args>
+  bool SymLazy(std::string_view funName, DlLazyFun<R, Args...> &outFun) {
+    return SelfDlSymLazy(funName, outFun);
+  }
+};
+
+constexpr uint64_t kCalls = 1000;
+
+// Run loop(callable) for each strategy; loop makes kCalls calls
+template <class R, class... Args, class Loop>
+static void BenchShape(bench::Runner &runner, BenchLib &lib,
+                       const std::string &shape, R (*direct)(Args...),
+                       Loop loop) {
+  DlFun<R, Args...> fun;
+  DlLazyFun<R, Args...> lazy;
+  std::string symbol = "dlutils_dispatch_" + shape;
+  if (!lib.Sym(symbol, fun) || !lib.SymLazy(symbol, lazy)) {
+    std::fprintf(stderr, "cannot resolve %s\n", symbol.c_str());
+    return;
+  }
+  lazy.Bind();
+  R (*raw)(Args...) = fun.Get();
+  std::function<R(Args...)> function = raw;
+  auto unchecked = fun.Unchecked();
+
+  std::string prefix = "dispatch/" + shape + "/";
+  runner.Run(prefix + "direct", kCalls, [&]() { loop(direct); });
+  runner.Run(prefix + "raw-pointer", kCalls, [&]() { loop(raw); });
+  runner.Run(prefix + "std::function", kCalls, [&]() { loop(function); });
+  runner.Run(prefix + "DlFun", kCalls, [&]() { loop(fun); });
+  runner.Run(prefix + "DlUncheckedFun", kCalls, [&]() { loop(unchecked); });
+  runner.Run(prefix + "DlLazyFun/bound", kCalls, [&]() { loop(lazy); });
+}
+
+static void BenchDispatch(bench::Runner &runner) {
+  BenchLib lib(DLUTILS_DISPATCH_LIB);
+  if (!lib.Open()) {
+    std::fprintf(stderr, "cannot open %s\n", DLUTILS_DISPATCH_LIB);
+    return;
+  }
+
+  BenchShape(runner, lib, "zero", dlutils_direct_zero, [](auto &&f) {
+    int x = 0;
+    for (uint64_t i = 0; i < kCalls; i++) {
+      x += f();
+    }
+    bench::DoNotOptimize(x);
+  });
+  BenchShape(runner, lib, "one", dlutils_direct_one, [](auto &&f) {
+    int x = 0;
+    for (uint64_t i = 0; i < kCalls; i++) {
+      x = f(x);
+    }
+    bench::DoNotOptimize(x);
+  });
+  BenchShape(runner, lib, "two_double", dlutils_direct_two_double,
+             [](auto &&f) {
+               double x = 0;
+               for (uint64_t i = 0; i < kCalls; i++) {
+                 x = f(x, 1.0);
+               }
+               bench::DoNotOptimize(x);
+             });
+  BenchShape(runner, lib, "update", dlutils_direct_update, [](auto &&f) {
+    size_t ctx = 0;
+    unsigned char block[64] = {1};
+    for (uint64_t i = 0; i < kCalls; i++) {
+      f(&ctx, block, sizeof(block));
+    }
+    bench::DoNotOptimize(ctx);
+  });
+}
+
+} // namespace dlutils
+
+int main(int argc, char **argv) {
+  dlutils::bench::Runner runner(argc, argv);
+  dlutils::BenchDispatch(runner);
+  return 0;
+}
@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// One out-of-line call per dispatch strategy, for inspecting the generated
+// code. The dispatch_codegen target keeps the assembly of this file (see
+// "Running Benchmarks" in README.md); nothing links against it. Compare, for
+// each function, the instructions between entry and the indirect call.
+
+#include "dlutils/dlutils.hpp"
+
+#include <cstddef>
+#include <functional>
+
+namespace {
+
+using UpdateFn = int(void *, const void *, size_t);
+
+} // namespace
+
+extern "C" {
+
+int dlutils_direct_update(void *ctx, const void *data, size_t len);
+
+int dlutils_codegen_direct(void *ctx, const void *data, size_t len) {
+  return dlutils_direct_update(ctx, data, len);
+}
+
+int dlutils_codegen_raw_pointer(UpdateFn *fn, void *ctx, const void *data,
+                                size_t len) {
+  return fn(ctx, data, len);
+}
+
+int dlutils_codegen_std_function(const std::function<UpdateFn> &fn, void *ctx,
+                                 const void *data, size_t len) {
+  return fn(ctx, data, len);
+}
+
+int dlutils_codegen_dlfun(
+    const dlutils::DlFun<int, void *, const void *, size_t> &fn, void *ctx,
+    const void *data, size_t len) {
+  return fn(ctx, data, len);
+}
+
+int dlutils_codegen_dlunchecked(
+    const dlutils::DlUncheckedFun<int, void *, const void *, size_t> &fn,
+    void *ctx, const void *data, size_t len) {
+  return fn(ctx, data, len);
+}
+
+int dlutils_codegen_dllazy(
+    const dlutils::DlLazyFun<int, void *, const void *, size_t> &fn, void *ctx,
+    const void *data, size_t len) {
+  return fn(ctx, data, len);
+}
+
+} // extern "C"
@@ -0,0 +1,52 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Call targets of dispatch_bench, one per argument shape. This file is built
+// twice: as the shared library loaded through dlutils, and with
+// DLUTILS_DISPATCH_DIRECT as a static library linked into the benchmark, so
+// the direct calls reach identical code under different names. The bodies are
+// trivial on purpose: the benchmark measures the dispatch, not the callee.
+
+#include <stddef.h>
+
+#ifdef DLUTILS_DISPATCH_DIRECT
+#define DLUTILS_DISPATCH_NAME(NAME) dlutils_direct_##NAME
+#else
+#define DLUTILS_DISPATCH_NAME(NAME) dlutils_dispatch_##NAME
+#endif
+
+// No arguments
+int DLUTILS_DISPATCH_NAME(zero)(void) { return 1; }
+
+// One integer argument
+int DLUTILS_DISPATCH_NAME(one)(int x) { return x + 1; }
+
+// Two floating-point arguments
+double DLUTILS_DISPATCH_NAME(two_double)(double a, double b) {
+  return a * 0.5 + b;
+}
+
+// EVP_DigestUpdate-style: a context, a buffer and its size
+int DLUTILS_DISPATCH_NAME(update)(void *ctx, const void *data, size_t len) {
+  *(size_t *)ctx += len + ((const unsigned char *)data)[0];
+  return 1;
+}
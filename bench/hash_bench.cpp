@@ -0,0 +1,164 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Multi-threaded SHA-256 throughput through the LibCrypto wrapper of
+// test/openssl.hpp, against libcrypto linked into the benchmark (when CMake
+// found OpenSSL, see DLUTILS_HASH_BENCH_DIRECT).
+//
+// Options:
+//   --threads=<n>      Largest thread count (default: hardware concurrency);
+//                      1, 2, 4, ... up to n are measured
+//   --corpus-mib=<n>   Corpus size in MiB (default: 64)
+//   --block-kib=<n>    Block size in KiB, one digest per block (default: 16)
+//   --min-time=<s>     Time per measurement in seconds (default: 0.5)
+//   --min-ratio=<r>    Exit with status 1 if the dlutils throughput is below
+//                      r times the direct one at any thread count, e.g. 0.95
+
+#include "hash_pipeline.hpp"
+#include "openssl.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+namespace dlutils::bench {
+
+uint64_t HashWithDlutils(const HashSlice &slice,
+                         const std::atomic<bool> &stop) {
+  auto &libcrypto = LibCrypto::GetInstance();
+  EVP_MD_CTX *ctx = libcrypto.EVP_MD_CTX_new();
+  const EVP_MD *md = libcrypto.EVP_sha256();
+  uint64_t bytes = 0;
+  do {
+    for (size_t b = 0; b < slice.blocks; b++) {
+      unsigned int len = 0;
+      libcrypto.EVP_DigestInit_ex(ctx, md, nullptr);
+      libcrypto.EVP_DigestUpdate(ctx, slice.data + b * slice.blockSize,
+                                 slice.blockSize);
+      libcrypto.EVP_DigestFinal_ex(ctx, slice.digests + b * kDigestSize, &len);
+    }
+    bytes += slice.blocks * slice.blockSize;
+  } while (!stop.load(std::memory_order_relaxed));
+  libcrypto.EVP_MD_CTX_free(ctx);
+  return bytes;
+}
+
+} // namespace dlutils::bench
+
+namespace {
+
+// Parse "--name=<value>" into value, if arg is that option
+bool ParseOption(const char *arg, const char *name, double *value) {
+  size_t len = std::strlen(name);
+  if (std::strncmp(arg, name, len) != 0 || arg[len] != '=') {
+    return false;
+  }
+  *value = std::atof(arg + len + 1);
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  using namespace dlutils::bench;
+
+  double maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  double corpusMib = 64;
+  double blockKib = 16;
+  double minTime = 0.5;
+  double minRatio = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!ParseOption(argv[i], "--threads", &maxThreads) &&
+        !ParseOption(argv[i], "--corpus-mib", &corpusMib) &&
+        !ParseOption(argv[i], "--block-kib", &blockKib) &&
+        !ParseOption(argv[i], "--min-time", &minTime) &&
+        !ParseOption(argv[i], "--min-ratio", &minRatio)) {
+      std::fprintf(stderr, "unknown option %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  if (!dlutils::LibCrypto::GetInstance().CheckOk()) {
+    std::fprintf(stderr, "failed to load libcrypto\n");
+    return 2;
+  }
+
+  const size_t blockSize = static_cast<size_t>(blockKib * 1024);
+  const size_t corpusSize = static_cast<size_t>(corpusMib * 1024 * 1024);
+  if (blockSize == 0 || corpusSize < blockSize) {
+    std::fprintf(stderr, "the corpus must hold at least one block\n");
+    return 2;
+  }
+  std::vector<unsigned char> corpus(corpusSize);
+  std::mt19937_64 rng(42);
+  for (auto &byte : corpus) {
+    byte = static_cast<unsigned char>(rng());
+  }
+  const std::chrono::duration<double> duration(minTime);
+
+  std::printf("corpus %.0f MiB, blocks of %.0f KiB, %.2f s per run\n",
+              corpusMib, blockKib, minTime);
+  std::printf("%8s %14s %14s", "threads", "dlutils GB/s", "per-core GB/s");
+#ifdef DLUTILS_HASH_BENCH_DIRECT
+  std::printf(" %14s %14s %8s", "direct GB/s", "per-core GB/s", "ratio");
+#endif
+  std::printf("\n");
+
+  bool regressed = false;
+  std::vector<unsigned char> digests;
+#ifdef DLUTILS_HASH_BENCH_DIRECT
+  std::vector<unsigned char> expected;
+#endif
+  for (size_t threads = 1; threads <= static_cast<size_t>(maxThreads);
+       threads *= 2) {
+    double dl = RunHashPipeline(HashWithDlutils, corpus, blockSize, threads,
+                                duration, digests) /
+                1e9;
+    std::printf("%8zu %14.3f %14.3f", threads, dl, dl / threads);
+#ifdef DLUTILS_HASH_BENCH_DIRECT
+    double direct = RunHashPipeline(HashDirect, corpus, blockSize, threads,
+                                    duration, expected) /
+                    1e9;
+    double ratio = dl / direct;
+    std::printf(" %14.3f %14.3f %8.3f", direct, direct / threads, ratio);
+    if (digests != expected) {
+      std::printf("\n");
+      std::fprintf(stderr, "the digests of both workers differ\n");
+      return 2;
+    }
+    if (ratio < minRatio) {
+      regressed = true;
+    }
+#endif
+    std::printf("\n");
+    std::fflush(stdout);
+  }
+
+  if (regressed) {
+    std::fprintf(stderr, "dlutils throughput is below %.2f of direct\n",
+                 minRatio);
+    return 1;
+  }
+  return 0;
+}
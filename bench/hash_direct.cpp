@@ -0,0 +1,50 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// The baseline of hash_bench: the same worker as HashWithDlutils, calling a
+// libcrypto linked into the benchmark. This lives in its own translation unit
+// since <openssl/evp.h> conflicts with the declarations of test/openssl.hpp.
+
+#include "hash_pipeline.hpp"
+
+#include <openssl/evp.h>
+
+namespace dlutils::bench {
+
+uint64_t HashDirect(const HashSlice &slice, const std::atomic<bool> &stop) {
+  EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+  const EVP_MD *md = EVP_sha256();
+  uint64_t bytes = 0;
+  do {
+    for (size_t b = 0; b < slice.blocks; b++) {
+      unsigned int len = 0;
+      EVP_DigestInit_ex(ctx, md, nullptr);
+      EVP_DigestUpdate(ctx, slice.data + b * slice.blockSize, slice.blockSize);
+      EVP_DigestFinal_ex(ctx, slice.digests + b * kDigestSize, &len);
+    }
+    bytes += slice.blocks * slice.blockSize;
+  } while (!stop.load(std::memory_order_relaxed));
+  EVP_MD_CTX_free(ctx);
+  return bytes;
+}
+
+} // namespace dlutils::bench
@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/// @brief A multi-threaded SHA-256 hashing pipeline over an in-memory corpus
+///
+/// The corpus is split into fixed-size blocks, and each of N threads hashes
+/// a contiguous slice of them, one digest per block, with its own reused
+/// EVP_MD_CTX. The hashing itself is done by a HashWorker, so the same
+/// pipeline measures libcrypto called through LibCrypto and linked directly.
+namespace dlutils::bench {
+
+/// @brief The size of a SHA-256 digest
+inline constexpr size_t kDigestSize = 32;
+
+/// @brief The slice of the corpus hashed by one thread
+struct HashSlice {
+  const unsigned char *data; ///< The first block of the slice
+  size_t blocks;             ///< The number of blocks
+  size_t blockSize;          ///< The size of each block
+  unsigned char *digests;    ///< Receives kDigestSize bytes per block
+};
+
+/// @brief Hashes a slice over and over until stop is set
+///
+/// Each call makes at least one full pass, so all digests get written.
+///
+/// @return The number of bytes hashed
+using HashWorker = uint64_t (*)(const HashSlice &slice,
+                                const std::atomic<bool> &stop);
+
+/// @brief Hash a corpus on several threads for a fixed duration
+/// @param worker The hashing implementation
+/// @param corpus The corpus
+/// @param blockSize The size of each block
+/// @param threads The number of threads
+/// @param duration How long to hash
+/// @param digests Receives the digests (kDigestSize bytes per block)
+/// @return The throughput in bytes per second
+inline double RunHashPipeline(HashWorker worker,
+                              const std::vector<unsigned char> &corpus,
+                              size_t blockSize, size_t threads,
+                              std::chrono::duration<double> duration,
+                              std::vector<unsigned char> &digests) {
+  const size_t blocks = corpus.size() / blockSize;
+  digests.resize(blocks * kDigestSize);
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> bytes{0};
+  std::vector<std::thread> pool;
+  const size_t perThread = (blocks + threads - 1) / threads;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < threads; t++) {
+    size_t first = std::min(blocks, t * perThread);
+    size_t last = std::min(blocks, first + perThread);
+    HashSlice slice{corpus.data() + first * blockSize, last - first, blockSize,
+                    digests.data() + first * kDigestSize};
+    pool.emplace_back([worker, slice, &stop, &bytes]() {
+      bytes.fetch_add(worker(slice, stop), std::memory_order_relaxed);
+    });
+  }
+  std::this_thread::sleep_for(duration);
+  stop.store(true, std::memory_order_relaxed);
+  for (auto &thread : pool) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return static_cast<double>(bytes.load()) / elapsed.count();
+}
+
+/// @brief The worker calling libcrypto through the LibCrypto wrapper
+uint64_t HashWithDlutils(const HashSlice &slice, const std::atomic<bool> &stop);
+
+#ifdef DLUTILS_HASH_BENCH_DIRECT
+/// @brief The worker calling a libcrypto linked into the benchmark
+uint64_t HashDirect(const HashSlice &slice, const std::atomic<bool> &stop);
+#endif
+
+} // namespace dlutils::bench
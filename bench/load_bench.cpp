@@ -0,0 +1,238 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Start-up cost benchmarks: dlopen, symbol resolution, cache validation, and
+// the call overhead of the DlFun wrappers against a raw function pointer.
+//
+// The synthetic library (DLUTILS_SYNTHETIC_LIB) exports
+// DLUTILS_SYNTHETIC_COUNT functions named dlutils_synth_<i>, see
+// cmake/synthetic.cmake.
+
+#include "bench.hpp"
+#include "dlutils/dlutils.hpp"
+
+#include <string>
+#include <vector>
+
+namespace dlutils {
+
+// Exposes the protected DlLibBase API to the benchmarks
+class BenchLib : public DlLibBase {
+public:
+  explicit BenchLib(std::string_view lib,
+                    DlOpenFlags flags = DlOpenFlags::kDefault)
+      : DlLibBase(lib, flags) {}
+
+  bool Open() { return SelfDlOpen(); }
+
+  bool Close() { return SelfDlClose(); }
+
+  template <class R, class... Args>
+  bool Sym(std::string_view funName, DlFun<R, Args...> &outFun) {
+    return SelfDlSym(funName, outFun);
+  }
+
+  template <class R, class... Args>
+  bool SymLazy(std::string_view funName, DlLazyFun<R, Args...> &outFun) {
+    return SelfDlSymLazy(funName, outFun);
+  }
+
+  template <class... Entries> bool Table(const Entries &...entries) {
+    return SelfDlSymTable(entries...);
+  }
+
+  bool Check() const { return CheckFunCache(); }
+};
+
+// Signatures of the libcrypto functions, pointer types kept opaque
+struct CryptoFuns {
+  DlFun<void *> EVP_MD_CTX_new;
+  DlFun<const void *> EVP_sha256;
+  DlFun<const void *> EVP_sha1;
+  DlFun<int, void *, const void *, void *> EVP_DigestInit_ex;
+  DlFun<int, void *, const void *, size_t> EVP_DigestUpdate;
+  DlFun<int, void *, unsigned char *, unsigned int *> EVP_DigestFinal_ex;
+  DlFun<void, void *> EVP_MD_CTX_free;
+};
+
+static void BenchOpen(bench::Runner &runner) {
+  runner.Run("SelfDlOpen+SelfDlClose/synthetic/now-global", 1, []() {
+    BenchLib lib(DLUTILS_SYNTHETIC_LIB);
+    lib.Open();
+    lib.Close();
+  });
+  runner.Run("SelfDlOpen+SelfDlClose/synthetic/lazy-local", 1, []() {
+    BenchLib lib(DLUTILS_SYNTHETIC_LIB,
+                 DlOpenFlags::kLazy | DlOpenFlags::kLocal);
+    lib.Open();
+    lib.Close();
+  });
+  runner.Run("SelfDlOpen+SelfDlClose/libcrypto", 1, []() {
+    BenchLib lib("libcrypto.so");
+    lib.Open();
+    lib.Close();
+  });
+
+  // Keep the library loaded: dlopen only bumps its reference count
+  void *pin = dlopen(DLUTILS_SYNTHETIC_LIB, RTLD_NOW);
+  runner.Run("SelfDlOpen+SelfDlClose/synthetic/already-loaded", 1, []() {
+    BenchLib lib(DLUTILS_SYNTHETIC_LIB);
+    lib.Open();
+    lib.Close();
+  });
+  dlclose(pin);
+}
+
+static void BenchSym(bench::Runner &runner,
+                     const std::vector<std::string> &names) {
+  using Clock = std::chrono::steady_clock;
+  const uint64_t n = names.size();
+
+  BenchLib lib(DLUTILS_SYNTHETIC_LIB);
+  lib.Open();
+  void *handle = dlopen(DLUTILS_SYNTHETIC_LIB, RTLD_NOW | RTLD_NOLOAD);
+  std::vector<DlFun<int, int>> funs(n);
+
+  runner.Run("dlsym/synthetic/per-symbol", n, [&]() {
+    for (const auto &name : names) {
+      bench::DoNotOptimize(dlsym(handle, name.c_str()));
+    }
+  });
+  runner.RunTimed("SelfDlSym/synthetic/cold-cache/per-symbol", n, [&]() {
+    BenchLib fresh(DLUTILS_SYNTHETIC_LIB);
+    fresh.Open();
+    internal::DlSymbolCache::GetInstance().Invalidate(handle);
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < n; i++) {
+      fresh.Sym(names[i], funs[i]);
+    }
+    return Clock::now() - start;
+  });
+  runner.RunTimed("SelfDlSym/synthetic/cached/per-symbol", n, [&]() {
+    BenchLib fresh(DLUTILS_SYNTHETIC_LIB);
+    fresh.Open();
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < n; i++) {
+      fresh.Sym(names[i], funs[i]);
+    }
+    return Clock::now() - start;
+  });
+
+  for (uint64_t i = 0; i < n; i++) {
+    lib.Sym(names[i], funs[i]);
+  }
+  runner.Run("CheckFunCache/synthetic/all-symbols", 1,
+             [&]() { bench::DoNotOptimize(lib.Check()); });
+  dlclose(handle);
+}
+
+static void BenchTable(bench::Runner &runner) {
+  using Clock = std::chrono::steady_clock;
+  CryptoFuns f;
+
+  runner.RunTimed("SelfDlSym/libcrypto/7-symbols/per-symbol", 7, [&]() {
+    BenchLib lib("libcrypto.so");
+    lib.Open();
+    auto start = Clock::now();
+    lib.Sym("EVP_MD_CTX_new", f.EVP_MD_CTX_new);
+    lib.Sym("EVP_sha256", f.EVP_sha256);
+    lib.Sym("EVP_sha1", f.EVP_sha1);
+    lib.Sym("EVP_DigestInit_ex", f.EVP_DigestInit_ex);
+    lib.Sym("EVP_DigestUpdate", f.EVP_DigestUpdate);
+    lib.Sym("EVP_DigestFinal_ex", f.EVP_DigestFinal_ex);
+    lib.Sym("EVP_MD_CTX_free", f.EVP_MD_CTX_free);
+    return Clock::now() - start;
+  });
+  runner.RunTimed("SelfDlSymTable/libcrypto/7-symbols/per-symbol", 7, [&]() {
+    BenchLib lib("libcrypto.so");
+    lib.Open();
+    auto start = Clock::now();
+    lib.Table(MakeDlSymEntry("EVP_MD_CTX_new", f.EVP_MD_CTX_new),
+              MakeDlSymEntry("EVP_sha256", f.EVP_sha256),
+              MakeDlSymEntry("EVP_sha1", f.EVP_sha1),
+              MakeDlSymEntry("EVP_DigestInit_ex", f.EVP_DigestInit_ex),
+              MakeDlSymEntry("EVP_DigestUpdate", f.EVP_DigestUpdate),
+              MakeDlSymEntry("EVP_DigestFinal_ex", f.EVP_DigestFinal_ex),
+              MakeDlSymEntry("EVP_MD_CTX_free", f.EVP_MD_CTX_free));
+    return Clock::now() - start;
+  });
+}
+
+static void BenchCall(bench::Runner &runner) {
+  constexpr uint64_t kCalls = 1000;
+  BenchLib lib(DLUTILS_SYNTHETIC_LIB);
+  lib.Open();
+  DlFun<int, int> fun;
+  DlLazyFun<int, int> lazy;
+  lib.Sym("dlutils_synth_1", fun);
+  lib.SymLazy("dlutils_synth_1", lazy);
+  lazy.Bind();
+  auto raw = fun.Get();
+  auto unchecked = fun.Unchecked();
+
+  runner.Run("call/raw-pointer", kCalls, [&]() {
+    int x = 0;
+    for (uint64_t i = 0; i < kCalls; i++) {
+      x = raw(x);
+    }
+    bench::DoNotOptimize(x);
+  });
+  runner.Run("call/DlFun", kCalls, [&]() {
+    int x = 0;
+    for (uint64_t i = 0; i < kCalls; i++) {
+      x = fun(x);
+    }
+    bench::DoNotOptimize(x);
+  });
+  runner.Run("call/DlUncheckedFun", kCalls, [&]() {
+    int x = 0;
+    for (uint64_t i = 0; i < kCalls; i++) {
+      x = unchecked(x);
+    }
+    bench::DoNotOptimize(x);
+  });
+  runner.Run("call/DlLazyFun/bound", kCalls, [&]() {
+    int x = 0;
+    for (uint64_t i = 0; i < kCalls; i++) {
+      x = lazy(x);
+    }
+    bench::DoNotOptimize(x);
+  });
+}
+
+} // namespace dlutils
+
+int main(int argc, char **argv) {
+  dlutils::bench::Runner runner(argc, argv);
+
+  std::vector<std::string> names;
+  names.reserve(DLUTILS_SYNTHETIC_COUNT);
+  for (int i = 0; i < DLUTILS_SYNTHETIC_COUNT; i++) {
+    names.push_back("dlutils_synth_" + std::to_string(i));
+  }
+
+  dlutils::BenchOpen(runner);
+  dlutils::BenchSym(runner, names);
+  dlutils::BenchTable(runner);
+  dlutils::BenchCall(runner);
+  return 0;
+}
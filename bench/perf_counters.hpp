@@ -0,0 +1,136 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dlutils::bench {
+
+/// @brief Hardware counters of the calling thread, read with perf_event_open
+///
+/// Counts user-space instructions and branch misses as one group, so both
+/// cover exactly the same interval. Opening the counters fails without
+/// kernel support or when perf_event_paranoid forbids it (common in
+/// containers); IsOpen() is false then and Stop() reports zeros.
+class PerfCounters {
+public:
+  /// @brief The counter values of one interval
+  struct Values {
+    uint64_t instructions = 0; ///< Retired user-space instructions
+    uint64_t branchMisses = 0; ///< Mispredicted user-space branches
+  };
+
+  /// @brief Open the counters (disabled until Start())
+  PerfCounters() {
+#if defined(__linux__)
+    leader_ = Open(PERF_COUNT_HW_INSTRUCTIONS, -1);
+    if (leader_ >= 0) {
+      member_ = Open(PERF_COUNT_HW_BRANCH_MISSES, leader_);
+      if (member_ < 0) {
+        close(leader_);
+        leader_ = -1;
+      }
+    }
+#endif
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  /// @brief Close the counters
+  ~PerfCounters() {
+#if defined(__linux__)
+    if (member_ >= 0) {
+      close(member_);
+    }
+    if (leader_ >= 0) {
+      close(leader_);
+    }
+#endif
+  }
+
+  /// @brief Check whether the counters could be opened
+  /// @return true if Start() and Stop() count
+  bool IsOpen() const { return leader_ >= 0; }
+
+  /// @brief Reset and start counting
+  void Start() {
+#if defined(__linux__)
+    if (IsOpen()) {
+      ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  /// @brief Stop counting
+  /// @return The values counted since Start()
+  Values Stop() {
+    Values values;
+#if defined(__linux__)
+    if (IsOpen()) {
+      ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      struct {
+        uint64_t nr;
+        uint64_t values[2];
+      } group = {};
+      if (read(leader_, &group, sizeof(group)) ==
+              static_cast<ssize_t>(sizeof(group)) &&
+          group.nr == 2) {
+        values.instructions = group.values[0];
+        values.branchMisses = group.values[1];
+      }
+    }
+#endif
+    return values;
+  }
+
+private:
+#if defined(__linux__)
+  /// @brief Open one hardware counter of the calling thread
+  static int Open(uint64_t config, int group) {
+    struct perf_event_attr attr = {};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = group < 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(
+        syscall(__NR_perf_event_open, &attr, 0, -1, group, 0));
+  }
+#endif
+
+  int leader_ = -1; ///< The group leader (instructions)
+  int member_ = -1; ///< The branch misses counter
+};
+
+} // namespace dlutils::bench
@@ -0,0 +1,41 @@
+# MIT License
+#
+# Copyright (c) 2025 Jamie Cui
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Generate a shared library exporting COUNT trivial functions
+#
+#   int dlutils_synth_<i>(int x) { return x + <i>; }   for i in [0, COUNT)
+#
+# The library is used to benchmark symbol resolution at scale.
+function(dlutils_add_synthetic_library TARGET COUNT)
+  set(SYNTHETIC_SRC ${CMAKE_CURRENT_BINARY_DIR}/${TARGET}.c)
+  set(SYNTHETIC_CONTENT "/* Generated by cmake/synthetic.cmake */\n")
+  math(EXPR SYNTHETIC_LAST "${COUNT} - 1")
+  foreach(I RANGE ${SYNTHETIC_LAST})
+    string(APPEND SYNTHETIC_CONTENT
+           "int dlutils_synth_${I}(int x) { return x + ${I}; }\n")
+  endforeach()
+  # file(GENERATE) only rewrites the source if the content changed
+  file(GENERATE OUTPUT ${SYNTHETIC_SRC} CONTENT "${SYNTHETIC_CONTENT}")
+
+  add_library(${TARGET} SHARED ${SYNTHETIC_SRC})
+  set_target_properties(${TARGET} PROPERTIES C_VISIBILITY_PRESET default)
+endfunction()
@@ -0,0 +1,93 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "dlutils/core.hpp"
+
+namespace dlutils {
+
+namespace internal {
+
+/// @brief The DlPendingLoad of DlLibBase::SelfLoadAsync
+///
+/// It holds the future of the loader, which runs on its own thread.
+class DlAsyncLoad : public DlPendingLoad {
+public:
+  /// @brief Constructor
+  /// @param future The future of the loader
+  explicit DlAsyncLoad(std::shared_future<bool> future)
+      : future_(std::move(future)) {}
+
+  /// @brief Wait for the loader to return
+  void Wait() const override { future_.wait(); }
+
+  /// @brief Wait for the loader and get its result
+  /// @return The result of the loader
+  /// @throws Any exception thrown by the loader
+  bool Get() const override { return future_.get(); }
+
+  /// @brief Check whether the loader has returned
+  /// @return true if the result is ready
+  bool IsDone() const {
+    return future_.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+  }
+
+  /// @brief Get the future of the loader
+  /// @return The future
+  const std::shared_future<bool> &GetFuture() const { return future_; }
+
+private:
+  std::shared_future<bool> future_; ///< The result of the loader
+};
+
+} // namespace internal
+
+template <class Loader> auto DlLibBase::SelfLoadAsync(Loader &&loader) {
+  std::lock_guard<std::mutex> lock(asyncMu_);
+  // pending_ only ever holds a DlAsyncLoad, made below
+  const auto *pending =
+      static_cast<const internal::DlAsyncLoad *>(pending_.get());
+  if (pending != nullptr && !pending->IsDone()) {
+    return pending->GetFuture();
+  }
+  loaded_.store(false, std::memory_order_release);
+  auto task = [this, loader = std::forward<Loader>(loader)]() mutable {
+    bool ok = loader();
+    loaded_.store(ok, std::memory_order_release);
+    return ok;
+  };
+  std::shared_future<bool> future =
+      std::async(std::launch::async, std::move(task)).share();
+  pending_ = std::make_shared<const internal::DlAsyncLoad>(future);
+  return future;
+}
+
+} // namespace dlutils
@@ -0,0 +1,334 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "dlutils/core.hpp"
+
+namespace dlutils {
+
+/// @brief A fixed-size pool of worker threads for batched calls
+///
+/// The pool only runs ParallelFor loops: the calling thread takes part in the
+/// loop, and the workers help it with the remaining chunks. A pool with zero
+/// workers runs every loop on the calling thread.
+class DlThreadPool {
+public:
+  /// @brief Constructor
+  /// @param threads The number of worker threads (besides the caller)
+  explicit DlThreadPool(size_t threads) {
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+      workers_.emplace_back([this]() { WorkerLoop(); });
+    }
+  }
+
+  /// @brief Destructor, joins the workers
+  ~DlThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  DlThreadPool(const DlThreadPool &) = delete;
+  DlThreadPool &operator=(const DlThreadPool &) = delete;
+
+  /// @brief Get the number of worker threads
+  /// @return The number of workers
+  size_t Size() const { return workers_.size(); }
+
+  /// @brief Run fn over [0, count) in chunks, and wait until all are done
+  ///
+  /// fn(begin, end) is called once per chunk of at most grain indices,
+  /// concurrently from the caller and the workers. The first exception thrown
+  /// by fn is rethrown here, after all running chunks have finished.
+  ///
+  /// @param count The number of indices
+  /// @param grain The maximum number of indices per chunk (at least 1)
+  /// @param fn The loop body, called as fn(begin, end)
+  template <class Fn> void ParallelFor(size_t count, size_t grain, Fn &&fn) {
+    grain = std::max<size_t>(grain, 1);
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks <= 1 || workers_.empty()) {
+      if (count > 0) {
+        fn(size_t{0}, count);
+      }
+      return;
+    }
+
+    Job job;
+    auto body = [&fn, &job, count, grain, chunks]() {
+      for (;;) {
+        size_t chunk = job.next.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= chunks) {
+          return;
+        }
+        size_t begin = chunk * grain;
+        try {
+          fn(begin, std::min(begin + grain, count));
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(job.mu);
+          if (!job.error) {
+            job.error = std::current_exception();
+          }
+        }
+      }
+    };
+    job.run = [](void *ctx) { (*static_cast<decltype(body) *>(ctx))(); };
+    job.ctx = &body;
+
+    const size_t helpers = std::min(workers_.size(), chunks - 1);
+    job.pending = helpers + 1;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      for (size_t i = 0; i < helpers; i++) {
+        queue_.push_back(&job);
+      }
+    }
+    cv_.notify_all();
+    Finish(job);
+
+    std::unique_lock<std::mutex> lock(job.mu);
+    job.done.wait(lock, [&job]() { return job.pending == 0; });
+    if (job.error) {
+      std::rethrow_exception(job.error);
+    }
+  }
+
+private:
+  /// @brief One ParallelFor loop, shared by the threads running it
+  struct Job {
+    void (*run)(void *) = nullptr; ///< Runs chunks until none are left
+    void *ctx = nullptr;           ///< The loop body passed to run
+    std::atomic<size_t> next{0};   ///< The next chunk to run
+    std::mutex mu;                 ///< Guards pending and error
+    std::condition_variable done;  ///< Signaled when pending reaches 0
+    size_t pending = 0;            ///< Threads still running the job
+    std::exception_ptr error;      ///< The first exception thrown
+  };
+
+  /// @brief Run the chunks of a job, then mark this thread as done with it
+  static void Finish(Job &job) {
+    job.run(job.ctx);
+    std::lock_guard<std::mutex> lock(job.mu);
+    if (--job.pending == 0) {
+      job.done.notify_all();
+    }
+  }
+
+  /// @brief The loop of a worker thread
+  void WorkerLoop() {
+    for (;;) {
+      Job *job = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+        job = queue_.front();
+        queue_.pop_front();
+      }
+      Finish(*job);
+    }
+  }
+
+  std::mutex mu_;                    ///< Guards queue_ and stop_
+  std::condition_variable cv_;       ///< Signaled when a job is queued
+  std::deque<Job *> queue_;          ///< The jobs waiting for a worker
+  bool stop_ = false;                ///< Whether the pool is shutting down
+  std::vector<std::thread> workers_; ///< The worker threads
+};
+
+template <class R, class... Args> class DlFun;
+
+namespace internal {
+
+/// @brief Prefetch the memory the pointer arguments of a call point to
+/// @param args The arguments of a call
+template <class Tuple> inline void PrefetchArgs(const Tuple &args) {
+  std::apply(
+      [](const auto &...arg) {
+        auto prefetch = [](const auto &a) {
+          using A = std::decay_t<decltype(a)>;
+          if constexpr (std::is_pointer_v<A> &&
+                        !std::is_function_v<std::remove_pointer_t<A>>) {
+#if defined(__GNUC__)
+            __builtin_prefetch(static_cast<const void *>(a));
+#endif
+          }
+        };
+        (prefetch(arg), ...);
+      },
+      args);
+}
+
+} // namespace internal
+
+/// @brief A call adapter that runs a loaded function over a batch of inputs
+///
+/// It is obtained from DlFun::Batch(), which checks the function pointer
+/// once. The loops then call the raw pointer (kept in a register) for every
+/// element, without the per-call checks of DlFun. Arguments are given either
+/// as an array of tuples or as one array per parameter, and results are
+/// written to an optional array.
+///
+/// With SetPrefetch(d), each iteration prefetches the memory that the pointer
+/// arguments of the element d positions ahead point to, e.g. the next input
+/// buffers of a hash update.
+///
+/// @tparam R The return type of the function
+/// @tparam Args The parameter types of the function
+template <class R, class... Args> class DlBatchFun {
+public:
+  /// @brief The function pointer type
+  using FunTy = R (*)(Args...);
+
+  /// @brief The arguments of one call
+  using ArgTuple = std::tuple<Args...>;
+
+  /// @brief Where the results are written (nullptr to discard them)
+  using ResultPtr = std::conditional_t<std::is_void_v<R>, std::nullptr_t, R *>;
+
+  /// @brief Get the underlying function pointer
+  /// @return The raw function pointer (never nullptr)
+  FunTy Get() const { return funptr_; }
+
+  /// @brief Prefetch the pointer arguments of upcoming elements
+  /// @param distance How many elements ahead to prefetch (0 disables it)
+  /// @return This adapter
+  DlBatchFun &SetPrefetch(size_t distance) {
+    prefetch_ = distance;
+    return *this;
+  }
+
+  /// @brief Call the function once per tuple of arguments
+  /// @param args The arguments of each call
+  /// @param count The number of calls
+  /// @param results Receives the result of each call (may be nullptr)
+  void operator()(const ArgTuple *args, size_t count,
+                  ResultPtr results = nullptr) const {
+    RunTuples(args, 0, count, results);
+  }
+
+  /// @brief Call the function once per index of parallel argument arrays
+  ///
+  /// The i-th call receives the i-th element of each column:
+  /// fun(columns[i]...).
+  ///
+  /// @param count The number of calls
+  /// @param results Receives the result of each call (may be nullptr)
+  /// @param columns One array per parameter of the function
+  template <class... Columns>
+  void CallColumns(size_t count, ResultPtr results,
+                   const Columns *...columns) const {
+    static_assert(sizeof...(Columns) == sizeof...(Args),
+                  "CallColumns needs one array per parameter");
+    FunTy funptr = funptr_;
+    for (size_t i = 0; i < count; i++) {
+      if (prefetch_ != 0 && i + prefetch_ < count) {
+        internal::PrefetchArgs(
+            std::forward_as_tuple(columns[i + prefetch_]...));
+      }
+      if constexpr (std::is_void_v<R>) {
+        funptr(columns[i]...);
+      } else if (results != nullptr) {
+        results[i] = funptr(columns[i]...);
+      } else {
+        funptr(columns[i]...);
+      }
+    }
+  }
+
+  /// @brief Split a batch of calls across a thread pool
+  ///
+  /// Same as operator(), except that chunks of grain calls run concurrently
+  /// on pool. The function must be safe to call from several threads at once
+  /// on the given arguments.
+  ///
+  /// @param pool The pool running the chunks
+  /// @param args The arguments of each call
+  /// @param count The number of calls
+  /// @param results Receives the result of each call (may be nullptr)
+  /// @param grain The number of calls per chunk
+  void Parallel(DlThreadPool &pool, const ArgTuple *args, size_t count,
+                ResultPtr results = nullptr, size_t grain = 1024) const {
+    pool.ParallelFor(count, grain, [this, args, results](size_t begin,
+                                                         size_t end) {
+      RunTuples(args, begin, end, results);
+    });
+  }
+
+private:
+  template <class, class...> friend class DlFun;
+
+  explicit DlBatchFun(FunTy funptr) : funptr_(funptr) {}
+
+  /// @brief Run the calls [begin, end) of a batch of tuples
+  void RunTuples(const ArgTuple *args, size_t begin, size_t end,
+                 ResultPtr results) const {
+    FunTy funptr = funptr_;
+    for (size_t i = begin; i < end; i++) {
+      if (prefetch_ != 0 && i + prefetch_ < end) {
+        internal::PrefetchArgs(args[i + prefetch_]);
+      }
+      if constexpr (std::is_void_v<R>) {
+        std::apply(funptr, args[i]);
+      } else if (results != nullptr) {
+        results[i] = std::apply(funptr, args[i]);
+      } else {
+        std::apply(funptr, args[i]);
+      }
+    }
+  }
+
+  FunTy funptr_;        ///< The function pointer (never nullptr)
+  size_t prefetch_ = 0; ///< The prefetch distance (0: no prefetching)
+};
+
+template <class R, class... Args>
+DlBatchFun<R, Args...> DlFun<R, Args...>::Batch() const {
+  FunTy funptr = internal::AtomicLoad(funptr_);
+  if (DLUTILS_UNLIKELY(funptr == nullptr)) {
+    internal::ThrowNullFun(funName_);
+  }
+  return DlBatchFun<R, Args...>(funptr);
+}
+
+} // namespace dlutils
@@ -0,0 +1,2183 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <dlfcn.h>
+#include <sched.h>
+#include <string>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dlutils/format.hpp"
+#include "dlutils/instrument.hpp"
+#include "dlutils/name_pool.hpp"
+#include "dlutils/symbol_cache.hpp"
+
+#if DLUTILS_ENABLE_INSTRUMENTATION
+#include <deque>
+#endif
+
+/// @brief Branch prediction and code placement hints
+///
+/// DLUTILS_UNLIKELY marks the error branches of the call path, and
+/// DLUTILS_COLD / DLUTILS_NOINLINE keep the throw path out of the callers.
+#if defined(__GNUC__) || defined(__clang__)
+#define DLUTILS_LIKELY(x) __builtin_expect(!!(x), 1)
+#define DLUTILS_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define DLUTILS_NOINLINE __attribute__((noinline))
+#define DLUTILS_COLD __attribute__((cold))
+#else
+#define DLUTILS_LIKELY(x) (x)
+#define DLUTILS_UNLIKELY(x) (x)
+#define DLUTILS_NOINLINE
+#define DLUTILS_COLD
+#endif
+
+/// @brief A header-only C++ library for dynamic loading utilities
+///
+/// This library provides safe and convenient wrappers around dlopen/dlsym
+/// for dynamically loading shared libraries at runtime.
+namespace dlutils {
+
+namespace internal {
+
+/// @brief Load a pointer published with AtomicStore (acquire semantics)
+///
+/// These helpers operate on plain members, so that the types holding the
+/// published pointers (e.g. DlFun) stay trivially copyable.
+///
+/// @param v The value to load
+/// @return The loaded value
+template <class T> inline T AtomicLoad(const T &v) {
+  return __atomic_load_n(&v, __ATOMIC_ACQUIRE);
+}
+
+/// @brief Publish a pointer to readers using AtomicLoad (release semantics)
+/// @param v The value to store to
+/// @param x The new value
+template <class T> inline void AtomicStore(T &v, T x) {
+  __atomic_store_n(&v, x, __ATOMIC_RELEASE);
+}
+
+/// @brief Throw the error for calling a function that was not loaded
+///
+/// This is kept out of line and marked cold so that the message formatting
+/// is not inlined into every DlFun call site.
+///
+/// @param funName The name of the function that is nullptr
+/// @throws std::runtime_error always
+[[noreturn]] DLUTILS_NOINLINE DLUTILS_COLD inline void
+ThrowNullFun(std::string_view funName) {
+  throw std::runtime_error(FormatString(
+      "[", __FILE__, ":", __LINE__, "] Fatal Error: function ", funName,
+      " is nullptr. This typically means dlsym failed to load the "
+      "function. ",
+      "Check that the library is properly loaded and the function name is "
+      "correct."));
+}
+
+/// @brief Constrains the call operators to the arguments the target accepts
+///
+/// The call operators forward their arguments as they were given, like
+/// std::invoke: a by-value parameter is copied once from an lvalue and moved
+/// once from an rvalue, and a reference parameter binds to the caller's
+/// object. Nothing is copied into the wrapper itself.
+template <class FunTy, class... CallArgs>
+using EnableIfCallable =
+    std::enable_if_t<std::is_invocable_v<FunTy, CallArgs...>, int>;
+
+template <class R, class... Args> class DlHookTable;
+
+} // namespace internal
+
+/// @brief Calls a loaded function over batches of inputs, defined in batch.hpp
+template <class R, class... Args> class DlBatchFun;
+
+/// @brief A call wrapper for a function that is known to be loaded
+///
+/// Unlike DlFun, this wrapper does not check the function pointer on each
+/// call. It can only be obtained from DlFun::Unchecked(), which validates the
+/// pointer once. Use it in hot loops, typically after the owning library has
+/// been validated with DlLibBase::Seal().
+///
+/// @tparam R The return type of the function
+/// @tparam Args The parameter types of the function
+template <class R, class... Args> class DlUncheckedFun {
+public:
+  /// @brief The function pointer type
+  using FunTy = R (*)(Args...);
+
+  /// @brief Get the underlying function pointer
+  /// @return The raw function pointer (never nullptr)
+  FunTy Get() const { return funptr_; }
+
+  /// @brief Call the function with the given arguments
+  /// @param args The arguments to pass to the function (forwarded)
+  /// @return The result of calling the function
+  template <class... CallArgs,
+            internal::EnableIfCallable<FunTy, CallArgs...> = 0>
+  R operator()(CallArgs &&...args) const
+      noexcept(std::is_nothrow_invocable_v<FunTy, CallArgs...>) {
+    return funptr_(std::forward<CallArgs>(args)...);
+  }
+
+private:
+  template <class, class...> friend class DlFun;
+
+  explicit DlUncheckedFun(FunTy funptr) : funptr_(funptr) {}
+
+  FunTy funptr_; ///< The function pointer (never nullptr)
+};
+
+/// @brief A wrapper class for dynamically loaded functions
+///
+/// This template class wraps function pointers obtained from dynamically loaded
+/// libraries. It provides safe function calling with nullptr checking and
+/// meaningful error messages. The target is stored as a raw function pointer,
+/// so a call through DlFun costs the same as calling the pointer directly.
+///
+/// The pointer is read with acquire semantics, so a DlFun may be called while
+/// its DlLibBase rebinds it on another thread (see DlLibBase::ReadGuard).
+///
+/// The name points into the internal::DlNamePool, whose names are
+/// null-terminated, so a DlFun is trivially copyable and only holds two
+/// pointers: the name and the target.
+///
+/// @tparam R The return type of the function
+/// @tparam Args The parameter types of the function
+template <class R, class... Args> class DlFun {
+public:
+  /// @brief The function pointer type
+  using FunTy = R (*)(Args...);
+
+  /// @brief Default constructor
+  DlFun() = default;
+
+  /// @brief Constructor with function name and pointer
+  /// @param name The name of the function (interned)
+  /// @param funptr The function pointer
+  DlFun(std::string_view name, FunTy funptr)
+      : funName_(internal::InternName(name).data()), funptr_(funptr) {}
+
+  /// @brief Get the underlying function pointer
+  /// @return The raw function pointer (nullptr if not loaded)
+  FunTy Get() const { return internal::AtomicLoad(funptr_); }
+
+  /// @brief Get the function name
+  /// @return A view of the interned name of the function
+  std::string_view GetName() const { return std::string_view(funName_); }
+
+  /// @brief Call the function with the given arguments
+  ///
+  /// This operator checks if the function pointer is valid before calling it.
+  /// If the pointer is nullptr, it throws a runtime_error with diagnostic
+  /// information.
+  ///
+  /// @param args The arguments to pass to the function (forwarded)
+  /// @return The result of calling the function
+  /// @throws std::runtime_error if the function pointer is nullptr
+  template <class... CallArgs,
+            internal::EnableIfCallable<FunTy, CallArgs...> = 0>
+  R operator()(CallArgs &&...args) const {
+    FunTy funptr = internal::AtomicLoad(funptr_);
+    if (DLUTILS_UNLIKELY(funptr == nullptr)) {
+      internal::ThrowNullFun(funName_);
+    }
+#if DLUTILS_ENABLE_INSTRUMENTATION
+    internal::DlCallTimer timer(stats_);
+#endif
+    return funptr(std::forward<CallArgs>(args)...);
+  }
+
+  /// @brief Get a call wrapper that skips the per-call nullptr check
+  ///
+  /// The function pointer is checked once here instead of on every call.
+  ///
+  /// @return A DlUncheckedFun calling the same function
+  /// @throws std::runtime_error if the function pointer is nullptr
+  DlUncheckedFun<R, Args...> Unchecked() const {
+    FunTy funptr = internal::AtomicLoad(funptr_);
+    if (DLUTILS_UNLIKELY(funptr == nullptr)) {
+      internal::ThrowNullFun(funName_);
+    }
+    return DlUncheckedFun<R, Args...>(funptr);
+  }
+
+  /// @brief Get an adapter that calls the function over batches of inputs
+  ///
+  /// The function pointer is checked once here, and the batch loops call it
+  /// without per-call checks. Batched calls are not instrumented.
+  ///
+  /// @return A DlBatchFun calling the same function (defined in
+  /// dlutils/batch.hpp)
+  /// @throws std::runtime_error if the function pointer is nullptr
+  DlBatchFun<R, Args...> Batch() const;
+
+private:
+  friend class DlLibBase;
+  friend class internal::DlHookTable<R, Args...>;
+
+  /// @brief Publish a new binding to concurrent callers
+  ///
+  /// The name is only written when it changes, so rebinding the same symbol
+  /// never races with readers of the name.
+  ///
+  /// @param name The interned name of the function
+  /// @param funptr The function pointer
+  void Publish(std::string_view name, FunTy funptr) {
+    if (funName_ != name.data()) {
+      funName_ = name.data();
+    }
+    internal::AtomicStore(funptr_, funptr);
+  }
+
+  const char *funName_ =
+      "unknown"; ///< The interned name of the function (default: "unknown")
+  FunTy funptr_ = nullptr; ///< The function pointer (default: nullptr)
+#if DLUTILS_ENABLE_INSTRUMENTATION
+  internal::DlFunStats *stats_ =
+      nullptr; ///< The call statistics, owned by the DlLibBase
+#endif
+};
+
+class DlLibBase;
+
+/// @brief A wrapper class for lazily bound functions
+///
+/// Unlike DlFun, a DlLazyFun is not resolved when it is loaded with
+/// DlLibBase::SelfDlSymLazy(). It starts unbound, and its first call runs
+/// dlsym through the owning DlLibBase and atomically patches the resolved
+/// pointer in, so that later calls go straight to the target (the same idea
+/// as a PLT entry). Concurrent first calls are safe: they all resolve the same
+/// pointer.
+///
+/// A DlLazyFun keeps a pointer to its owner, so it cannot be copied.
+///
+/// @tparam R The return type of the function
+/// @tparam Args The parameter types of the function
+template <class R, class... Args> class DlLazyFun {
+public:
+  /// @brief The function pointer type
+  using FunTy = R (*)(Args...);
+
+  /// @brief Default constructor
+  DlLazyFun() = default;
+
+  DlLazyFun(const DlLazyFun &) = delete;
+  DlLazyFun &operator=(const DlLazyFun &) = delete;
+
+  /// @brief Get the underlying function pointer
+  /// @return The raw function pointer (nullptr if not bound yet)
+  FunTy Get() const { return funptr_.load(std::memory_order_acquire); }
+
+  /// @brief Get the function name
+  /// @return A view of the interned name of the function
+  std::string_view GetName() const { return std::string_view(funName_); }
+
+  /// @brief Check whether the function has been resolved
+  /// @return true if the function pointer has been bound
+  bool IsBound() const { return Get() != nullptr; }
+
+  /// @brief Resolve the function now instead of on its first call
+  /// @return The resolved function pointer (nullptr if dlsym failed)
+  FunTy Bind() const;
+
+  /// @brief Call the function with the given arguments
+  ///
+  /// The first call resolves the function. If it cannot be resolved, a
+  /// runtime_error is thrown with diagnostic information.
+  ///
+  /// @param args The arguments to pass to the function (forwarded)
+  /// @return The result of calling the function
+  /// @throws std::runtime_error if the function cannot be resolved
+  template <class... CallArgs,
+            internal::EnableIfCallable<FunTy, CallArgs...> = 0>
+  R operator()(CallArgs &&...args) const {
+    FunTy funptr = funptr_.load(std::memory_order_acquire);
+    if (DLUTILS_UNLIKELY(funptr == nullptr)) {
+      funptr = BindOrThrow();
+    }
+#if DLUTILS_ENABLE_INSTRUMENTATION
+    internal::DlCallTimer timer(stats_);
+#endif
+    return funptr(std::forward<CallArgs>(args)...);
+  }
+
+private:
+  friend class DlLibBase;
+
+  /// @brief The slow path of the first call
+  DLUTILS_NOINLINE FunTy BindOrThrow() const {
+    FunTy funptr = Bind();
+    if (funptr == nullptr) {
+      internal::ThrowNullFun(funName_);
+    }
+    return funptr;
+  }
+
+  const DlLibBase *owner_ = nullptr; ///< The library resolving the function
+  const char *funName_ =
+      "unknown"; ///< The interned name of the function (default: "unknown")
+  mutable std::atomic<FunTy> funptr_{
+      nullptr}; ///< The bound function pointer (default: nullptr)
+#if DLUTILS_ENABLE_INSTRUMENTATION
+  internal::DlFunStats *stats_ =
+      nullptr; ///< The call statistics, owned by the DlLibBase
+#endif
+};
+
+/// @brief Hooks run around the calls of a DlFun, defined in hook.hpp
+template <class R, class... Args> struct DlHook;
+
+/// @brief One build of a library, defined in cpu_features.hpp
+struct DlLibVariant;
+
+namespace internal {
+
+/// @brief The type-erased operations of a DlHookTable, defined in hook.hpp
+struct DlHookOps;
+
+/// @brief Walks the live libraries, defined in registry.hpp
+class DlLibDirectory;
+
+/// @brief The list of live DlLibBase objects, in construction order
+///
+/// Every DlLibBase links itself in on construction and out on destruction.
+/// The list is constant-initialized, so it is never destroyed before them.
+struct DlLibList {
+  std::mutex mu;              ///< Guards the list and its links
+  DlLibBase *first = nullptr; ///< The oldest live library
+  DlLibBase *last = nullptr;  ///< The newest live library
+};
+
+/// @brief A distinct address for each function signature
+///
+/// DlLibBase records it with each bound DlFun, so that SetHook can find the
+/// DlFun objects of its signature without the hook tables.
+template <class R, class... Args> struct DlSignature {
+  static constexpr char kTag = 0; ///< Its address identifies R(Args...)
+};
+
+} // namespace internal
+
+/// @brief Flags controlling how DlLibBase::SelfDlOpen loads a library
+///
+/// These map onto the dlopen mode flags, see
+/// https://man7.org/linux/man-pages/man3/dlopen.3.html. Combine them with
+/// operator|. Exactly one binding mode is used: kLazy is honored only if kNow
+/// is not set. Likewise kLocal is honored only if kGlobal is not set.
+enum class DlOpenFlags : unsigned {
+  kNow = 1u << 0,      ///< RTLD_NOW: resolve all relocations at load time
+  kLazy = 1u << 1,     ///< RTLD_LAZY: resolve function relocations on use
+  kGlobal = 1u << 2,   ///< RTLD_GLOBAL: make the symbols globally visible
+  kLocal = 1u << 3,    ///< RTLD_LOCAL: keep the symbols out of global scope
+  kNoDelete = 1u << 4, ///< RTLD_NODELETE: never unload the library
+  kNoLoad = 1u << 5,   ///< RTLD_NOLOAD: only succeed if already loaded
+  kDeepBind = 1u << 6, ///< RTLD_DEEPBIND: prefer the library's own symbols
+  kDefault = kNow | kGlobal, ///< The flags used when none are given
+};
+
+/// @brief Combine two sets of DlOpenFlags
+inline constexpr DlOpenFlags operator|(DlOpenFlags a, DlOpenFlags b) {
+  return static_cast<DlOpenFlags>(static_cast<unsigned>(a) |
+                                  static_cast<unsigned>(b));
+}
+
+/// @brief Intersect two sets of DlOpenFlags
+inline constexpr DlOpenFlags operator&(DlOpenFlags a, DlOpenFlags b) {
+  return static_cast<DlOpenFlags>(static_cast<unsigned>(a) &
+                                  static_cast<unsigned>(b));
+}
+
+/// @brief Check whether a set of DlOpenFlags contains a flag
+/// @param flags The set of flags
+/// @param flag The flag to look for
+/// @return true if flag is set in flags
+inline constexpr bool HasFlag(DlOpenFlags flags, DlOpenFlags flag) {
+  return (flags & flag) == flag;
+}
+
+/// @brief Convert DlOpenFlags to the mode argument of dlopen
+/// @param flags The flags to convert
+/// @return The dlopen mode
+inline int ToDlOpenMode(DlOpenFlags flags) {
+  int mode = 0;
+  if (!HasFlag(flags, DlOpenFlags::kNow) &&
+      HasFlag(flags, DlOpenFlags::kLazy)) {
+    mode |= RTLD_LAZY;
+  } else {
+    mode |= RTLD_NOW;
+  }
+  if (HasFlag(flags, DlOpenFlags::kGlobal)) {
+    mode |= RTLD_GLOBAL;
+  } else {
+    mode |= RTLD_LOCAL;
+  }
+  if (HasFlag(flags, DlOpenFlags::kNoDelete)) {
+    mode |= RTLD_NODELETE;
+  }
+  if (HasFlag(flags, DlOpenFlags::kNoLoad)) {
+    mode |= RTLD_NOLOAD;
+  }
+#ifdef RTLD_DEEPBIND
+  if (HasFlag(flags, DlOpenFlags::kDeepBind)) {
+    mode |= RTLD_DEEPBIND;
+  }
+#endif
+  return mode;
+}
+
+/// @brief An entry of a symbol table resolved by DlLibBase::SelfDlSymTable
+///
+/// @tparam R The return type of the function
+/// @tparam Args The parameter types of the function
+template <class R, class... Args> struct DlSymEntry {
+  std::string_view name;  ///< The name of the symbol to load
+  DlFun<R, Args...> *fun; ///< The DlFun object to populate
+};
+
+/// @brief Create a DlSymEntry, deducing the template arguments from the DlFun
+/// @param name The name of the symbol to load
+/// @param fun The DlFun object to populate
+/// @return The symbol table entry
+template <class R, class... Args>
+constexpr DlSymEntry<R, Args...> MakeDlSymEntry(std::string_view name,
+                                                DlFun<R, Args...> &fun) {
+  return {name, &fun};
+}
+
+/// @brief The dense pointer storage of a generated symbol table
+///
+/// Holds the resolved pointers of a table declared with
+/// DLUTILS_DEFINE_SYMBOL_TABLE in one contiguous, cache-line-aligned array,
+/// indexed by the table's enumerators. Pointers are read with acquire
+/// semantics, like DlFun, so a table may be called while it is reloaded.
+///
+/// @tparam N The number of symbols of the table
+template <size_t N> class DlSymbolSlots {
+public:
+  /// @brief Get a resolved pointer
+  /// @tparam Sig The function type of the symbol
+  /// @param i The index of the symbol
+  /// @return The function pointer (nullptr if not loaded)
+  template <class Sig> Sig *Get(size_t i) const {
+    return reinterpret_cast<Sig *>(internal::AtomicLoad(ptrs_[i]));
+  }
+
+  /// @brief Call a resolved symbol
+  /// @tparam Sig The function type of the symbol
+  /// @param i The index of the symbol
+  /// @param name The name of the symbol, for the error message
+  /// @param args The arguments to pass to the function
+  /// @return The result of calling the function
+  /// @throws std::runtime_error if the function pointer is nullptr
+  template <class Sig, class... CallArgs>
+  decltype(auto) Call(size_t i, std::string_view name,
+                      CallArgs &&...args) const {
+    Sig *funptr = Get<Sig>(i);
+    if (DLUTILS_UNLIKELY(funptr == nullptr)) {
+      internal::ThrowNullFun(name);
+    }
+    return funptr(std::forward<CallArgs>(args)...);
+  }
+
+private:
+  friend class DlLibBase;
+
+  alignas(64) std::array<void *, N> ptrs_ = {}; ///< The resolved pointers
+};
+
+/// @brief How complete the binding of a library is
+///
+/// Returned by DlLibBase::GetStatus() and GetLoadedLibraries().
+struct DlLibStatus {
+  std::string name;      ///< The library name given to the constructor
+  std::string loadedLib; ///< The library SelfDlOpen loaded, empty if closed
+  bool sealed = false;   ///< Whether Seal() validated the functions
+  size_t boundSymbols = 0; ///< The number of symbols that resolved
+  size_t totalSymbols = 0; ///< The number of symbols that were loaded
+  std::vector<std::string> missingSymbols; ///< See GetMissingSymbols()
+};
+
+/// @brief What loading a library did, defined in load_report.hpp
+struct DlLoadReport;
+
+namespace internal {
+
+/// @brief A symbol lookup that DlLibBase tries before dlsym
+///
+/// The optional lookups implement this in their own headers: the GNU hash
+/// table of elf_symbols.hpp (see DlLibBase::SelfDlUseElfLookup) and the
+/// manifest of symbol_manifest.hpp (see DlLibBase::SelfDlUseManifest).
+class DlSymbolSource {
+public:
+  virtual ~DlSymbolSource() = default;
+
+  /// @brief Look up a symbol
+  /// @param name The symbol name (null-terminated)
+  /// @return The symbol address, nullptr if the source does not hold it
+  virtual void *Find(std::string_view name) const = 0;
+
+  /// @brief Look up a batch of symbols
+  /// @param names The symbol names (null-terminated)
+  /// @param out The symbol addresses, nullptr for the ones not found
+  /// @param n The number of symbols
+  virtual void FindBatch(const std::string_view *names, void **out,
+                         size_t n) const {
+    for (size_t i = 0; i < n; i++) {
+      out[i] = Find(names[i]);
+    }
+  }
+
+  /// @brief Note a symbol that Find() missed and dlsym resolved
+  /// @param name The symbol name
+  /// @param ptr The symbol address
+  virtual void Record(std::string_view name, void *ptr) {
+    (void)name;
+    (void)ptr;
+  }
+
+  /// @brief Add why the source lacks a symbol to a load report error
+  /// @param name The symbol name (null-terminated)
+  /// @param error The error so far, see AppendDlError
+  virtual void ExplainMissing(std::string_view name, std::string &error) const {
+    (void)name;
+    (void)error;
+  }
+};
+
+/// @brief State an opt-in header keeps in a DlLibBase
+///
+/// DlLibBase owns it through this base: it drops it when the library is
+/// closed or reloaded and hands it over on a move, and only the header that
+/// made it looks inside (e.g. the bound versions of versioning.hpp).
+class DlLibExtension {
+public:
+  virtual ~DlLibExtension() = default;
+};
+
+/// @brief Add the message of a failed dl* call to a load report error
+///
+/// Reads (and so clears) dlerror(). Messages are joined with "; ".
+///
+/// @param error The error so far
+/// @param missing Whether the call failed; otherwise only clears dlerror()
+inline void AppendDlError(std::string &error, bool missing) {
+  const char *message = dlerror();
+  if (missing && message != nullptr) {
+    error.append(error.empty() ? "" : "; ").append(message);
+  }
+}
+
+/// @brief A record of the dlopen calls and symbol lookups of a DlLibBase
+///
+/// Implemented by DlLoadLog in load_report.hpp, see
+/// DlLibBase::SelfDlEnableLoadReport.
+class DlLoadRecorder {
+public:
+  virtual ~DlLoadRecorder() = default;
+
+  /// @brief Read the clock timing the records
+  /// @return The current time, in nanoseconds
+  virtual uint64_t Now() const = 0;
+
+  /// @brief Record a dlopen call, read dlerror() right after it
+  /// @param lib The library passed to dlopen (interned)
+  /// @param start When dlopen was called, per Now()
+  /// @param handle The result of dlopen
+  virtual void RecordOpen(std::string_view lib, uint64_t start,
+                          const void *handle) = 0;
+
+  /// @brief Record a symbol lookup
+  /// @param name The name of the symbol (interned or static)
+  /// @param ns The time spent resolving it
+  /// @param ptr The resolved address, nullptr if it is missing
+  /// @param error Why a missing symbol is missing, empty if it was found
+  virtual void RecordSymbol(std::string_view name, uint64_t ns,
+                            const void *ptr, std::string_view error) = 0;
+};
+
+/// @brief A load started by DlLibBase::SelfLoadAsync, see async.hpp
+class DlPendingLoad {
+public:
+  virtual ~DlPendingLoad() = default;
+
+  /// @brief Wait for the load to finish, ignoring its result
+  virtual void Wait() const = 0;
+
+  /// @brief Wait for the load to finish
+  /// @return The result of the loader
+  /// @throws Any exception thrown by the loader
+  virtual bool Get() const = 0;
+};
+
+/// @brief Which of the loaded symbols of a library resolved, one bit each
+///
+/// DlLibBase only needs to know whether each loaded symbol resolved (the
+/// pointers themselves live in the DlFun objects and tables), so it keeps one
+/// bit per symbol instead of a copy of the pointer: 64 symbols per word.
+/// AllBound() and BoundCount() scan the words without early exits, which the
+/// compiler can vectorize.
+class DlBindingBits {
+public:
+  /// @brief Reserve room for a number of symbols in total
+  /// @param n The number of symbols
+  void Reserve(size_t n) { words_.reserve((n + kBits - 1) / kBits); }
+
+  /// @brief Append one symbol
+  /// @param bound Whether the symbol resolved
+  void Push(bool bound) {
+    if (size_ % kBits == 0) {
+      words_.push_back(0);
+    }
+    words_.back() |= static_cast<uint64_t>(bound) << (size_ % kBits);
+    size_++;
+  }
+
+  /// @brief Check whether one symbol resolved
+  /// @param i The index of the symbol, less than Size()
+  /// @return The bit of the symbol
+  bool Test(size_t i) const { return (words_[i / kBits] >> (i % kBits)) & 1; }
+
+  /// @brief Overwrite the bit of one symbol
+  /// @param i The index of the symbol, less than Size()
+  /// @param bound Whether the symbol resolved
+  void Set(size_t i, bool bound) {
+    const uint64_t bit = uint64_t{1} << (i % kBits);
+    words_[i / kBits] = bound ? words_[i / kBits] | bit
+                              : words_[i / kBits] & ~bit;
+  }
+
+  /// @brief Get the number of symbols
+  /// @return The number of symbols, resolved or not
+  size_t Size() const { return size_; }
+
+  /// @brief Check whether every symbol resolved
+  /// @return true if all symbols resolved (or there are none)
+  bool AllBound() const {
+    uint64_t all = ~uint64_t{0};
+    const size_t full = size_ / kBits;
+    for (size_t i = 0; i < full; i++) {
+      all &= words_[i];
+    }
+    if (all != ~uint64_t{0}) {
+      return false;
+    }
+    const size_t tail = size_ % kBits;
+    const uint64_t mask = (uint64_t{1} << tail) - 1;
+    return tail == 0 || (words_[full] & mask) == mask;
+  }
+
+  /// @brief Get the number of symbols that resolved
+  /// @return The number of set bits
+  size_t BoundCount() const {
+    size_t count = 0;
+    for (uint64_t word : words_) {
+      count += static_cast<size_t>(__builtin_popcountll(word));
+    }
+    return count;
+  }
+
+  /// @brief Remove all symbols
+  void Clear() {
+    words_.clear();
+    size_ = 0;
+  }
+
+private:
+  static constexpr size_t kBits = 64; ///< The bits per word
+
+  std::vector<uint64_t> words_; ///< The bits, symbol i at bit i % 64
+  size_t size_ = 0;             ///< The number of symbols
+};
+
+/// @brief The position of each bound target, by address
+///
+/// An open-addressing table, at most half full, from the address of a DlFun
+/// or table slot to its index in the bindings of a DlLibBase.
+class DlTargetIndex {
+public:
+  /// @brief Find a target, adding it if it is new
+  /// @param target The DlFun or table slot
+  /// @param next The index to give the target if it is new
+  /// @return The index of the target, and whether it was added
+  std::pair<size_t, bool> Insert(const void *target, size_t next) {
+    if (2 * (size_ + 1) > slots_.size()) {
+      Reserve(size_ + 1);
+    }
+    Slot &slot = FindSlot(slots_, target);
+    if (slot.target != nullptr) {
+      return {slot.index, false};
+    }
+    slot = Slot{target, next};
+    size_++;
+    return {next, true};
+  }
+
+  /// @brief Make room for a number of targets in total
+  /// @param n The number of targets
+  void Reserve(size_t n) {
+    size_t size = slots_.empty() ? 16 : slots_.size();
+    while (size < 2 * n) {
+      size *= 2;
+    }
+    if (size == slots_.size()) {
+      return;
+    }
+    std::vector<Slot> slots(size);
+    for (const Slot &slot : slots_) {
+      if (slot.target != nullptr) {
+        FindSlot(slots, slot.target) = slot;
+      }
+    }
+    slots_ = std::move(slots);
+  }
+
+  /// @brief Remove all targets
+  void Clear() {
+    slots_.clear();
+    size_ = 0;
+  }
+
+private:
+  /// @brief One entry, empty if target is nullptr
+  struct Slot {
+    const void *target = nullptr; ///< The DlFun or table slot
+    size_t index = 0;             ///< Its index in the bindings
+  };
+
+  /// @brief Find the slot of a target, or the empty one where it belongs
+  static Slot &FindSlot(std::vector<Slot> &slots, const void *target) {
+    const size_t mask = slots.size() - 1;
+    size_t i = static_cast<size_t>(
+        (reinterpret_cast<uintptr_t>(target) >> 3) * 0x9e3779b97f4a7c15ULL >>
+        32);
+    for (i &= mask;; i = (i + 1) & mask) {
+      if (slots[i].target == nullptr || slots[i].target == target) {
+        return slots[i];
+      }
+    }
+  }
+
+  std::vector<Slot> slots_; ///< The table, a power of two of slots or none
+  size_t size_ = 0;         ///< The number of targets
+};
+
+} // namespace internal
+
+/// @brief Base class for dynamic library loading
+///
+/// This class provides a foundation for loading dynamic libraries and their
+/// functions. It wraps dlopen/dlsym operations and provides utilities for
+/// managing loaded functions.
+///
+/// Thread safety: the loading functions (SelfDlOpen, SelfDlSym,
+/// SelfDlSymTable, ...) are serialized by an internal lock and may run while
+/// other threads call the loaded functions. Callers never take that lock:
+/// resolved pointers are published with release stores and read with acquire
+/// loads. Each load call publishes its bindings as one set (a reload
+/// publishes all the bindings of its loader as one set); code that makes
+/// several calls and needs them all to come from the same set holds a
+/// ReadGuard. Library handles are only closed by SelfDlClose and after the
+/// grace period of SelfDlReload, so a pointer obtained before a plain rebind
+/// stays callable. DlFun members must be bound once before they are shared
+/// between threads.
+class DlLibBase {
+public:
+  /// @brief A lock-free read-side guard for a consistent binding set
+  ///
+  /// All calls made while a ReadGuard is alive see the same binding set: a
+  /// concurrent load waits for the guards to be released before it publishes
+  /// new bindings, and a guard created during a load waits until the new set
+  /// is complete. Creating and releasing a guard are a few atomic operations.
+  ///
+  /// WARNING: Do not nest guards, and do not load symbols from a thread that
+  /// holds a guard on the same library; both can deadlock.
+  class ReadGuard {
+  public:
+    /// @brief Enter a read-side section on the library
+    /// @param lib The library whose bindings are read
+    explicit ReadGuard(const DlLibBase &lib) : lib_(lib) { lib_.EnterRead(); }
+
+    /// @brief Leave the read-side section
+    ~ReadGuard() { lib_.ExitRead(); }
+
+    ReadGuard(const ReadGuard &) = delete;
+    ReadGuard &operator=(const ReadGuard &) = delete;
+
+  private:
+    const DlLibBase &lib_; ///< The guarded library
+  };
+
+  /// @brief Get the number of binding sets published so far
+  ///
+  /// Each successful SelfDlSym or SelfDlSymTable call publishes one set,
+  /// except inside SelfDlReload, which publishes all the bindings of its
+  /// loader as a single set. This can be used to refresh DlUncheckedFun
+  /// wrappers after a reload.
+  ///
+  /// @return The number of published binding sets
+  uint64_t GetGeneration() const {
+    return generation_.load(std::memory_order_acquire) / 2;
+  }
+
+  /// @brief Check whether the library has been sealed
+  ///
+  /// A sealed library has had all of its functions validated by Seal(), so
+  /// the DlUncheckedFun wrappers obtained from its DlFun members are safe to
+  /// call.
+  ///
+  /// @return true if Seal() succeeded and no symbol was loaded since
+  bool IsSealed() const { return sealed_.load(std::memory_order_acquire); }
+
+  /// @brief Check whether symbols are looked up in the GNU hash table
+  /// @return true if SelfDlUseElfLookup found the GNU hash table of the
+  /// loaded library
+  bool UsesElfLookup() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return elfSymbols_ != nullptr;
+  }
+
+  /// @brief Check whether symbols are resolved from a valid manifest
+  /// @return true if SelfDlUseManifest mapped a manifest valid for the
+  /// loaded library (defined in dlutils/symbol_manifest.hpp)
+  bool HasValidManifest() const;
+
+  /// @brief Check whether the asynchronous load has finished successfully
+  ///
+  /// This is a single acquire load, so it can be polled on the hot path to
+  /// take a fallback path until the library is ready.
+  ///
+  /// @return true if the loader started by SelfLoadAsync returned true
+  bool IsLoaded() const { return loaded_.load(std::memory_order_acquire); }
+
+  /// @brief Wait for the asynchronous load to finish
+  /// @return The result of the loader, or IsLoaded() if no asynchronous load
+  /// was started
+  /// @throws Any exception thrown by the loader
+  bool WaitLoaded() const {
+    std::shared_ptr<const internal::DlPendingLoad> pending;
+    {
+      std::lock_guard<std::mutex> lock(asyncMu_);
+      pending = pending_;
+    }
+    if (pending == nullptr) {
+      return IsLoaded();
+    }
+    return pending->Get();
+  }
+
+  /// @brief Get the flags used to open the library
+  /// @return The flags given to the constructor
+  DlOpenFlags GetOpenFlags() const { return openFlags_; }
+
+  /// @brief Get the name of the library SelfDlOpen loaded
+  ///
+  /// With a list of variants, this is the variant that was chosen.
+  ///
+  /// @return The name of the loaded library, empty if none is loaded
+  std::string_view GetLoadedLib() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return loadedLib_;
+  }
+
+  /// @brief Get the fallback libraries added by SelfDlAddFallback
+  /// @return The names of the fallback libraries, in search order (defined
+  /// in dlutils/fallback.hpp)
+  std::vector<std::string_view> GetFallbackLibs() const;
+
+  /// @brief Get how complete the binding of the library is
+  /// @return The status of the library
+  DlLibStatus GetStatus() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    DlLibStatus status;
+    status.name = std::string(libName_);
+    if (libptr_.load(std::memory_order_relaxed) != nullptr) {
+      status.loadedLib = std::string(loadedLib_);
+    }
+    status.sealed = sealed_.load(std::memory_order_relaxed);
+    status.totalSymbols = funCache_.Size();
+    status.boundSymbols = funCache_.BoundCount();
+    status.missingSymbols = missingSyms_;
+    return status;
+  }
+
+  /// @brief Get what loading the library did
+  ///
+  /// Only recorded after SelfDlEnableLoadReport; otherwise the report is
+  /// empty. It lists every dlopen call (of SelfDlOpen, SelfDlReload and
+  /// SelfDlAddFallback) with its duration and dlerror() message, and every
+  /// symbol resolved by SelfDlSym, SelfDlVSym, SelfDlSymTable and
+  /// SelfDlLoadTable with its duration and the object it came from. Lazily
+  /// bound functions resolve without the loading lock and are not recorded.
+  /// The records are kept across reloads, in order.
+  ///
+  /// @return The load report (defined in dlutils/load_report.hpp)
+  DlLoadReport GetLoadReport() const;
+
+  /// @brief Get the names of the symbols that could not be resolved
+  ///
+  /// This holds the failures of the last SelfDlSymTable call, plus those of
+  /// any SelfDlSym call made after it.
+  ///
+  /// @return The names of the missing symbols
+  std::vector<std::string> GetMissingSymbols() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return missingSyms_;
+  }
+
+  /// @brief Get the version a symbol was bound to by SelfDlVSym
+  /// @param funName The name of the symbol
+  /// @return The bound version, or an empty string if the symbol was bound
+  /// to its default version or not loaded with SelfDlVSym (defined in
+  /// dlutils/versioning.hpp)
+  std::string GetBoundVersion(std::string_view funName) const;
+
+  /// @brief Get the call statistics of the loaded functions
+  ///
+  /// Only available when DLUTILS_ENABLE_INSTRUMENTATION is set; otherwise the
+  /// result is always empty. The per-thread shards are aggregated on each
+  /// call, in the order in which the functions were first loaded.
+  ///
+  /// @return The statistics of each loaded function
+  std::vector<DlCallStats> GetCallStats() const {
+    std::vector<DlCallStats> result;
+#if DLUTILS_ENABLE_INSTRUMENTATION
+    std::lock_guard<std::mutex> lock(mu_);
+    result.reserve(funStats_.size());
+    for (const auto &stats : funStats_) {
+      result.push_back(stats.Aggregate());
+    }
+#endif
+    return result;
+  }
+
+  /// @brief Reset the call statistics of all loaded functions
+  void ResetCallStats() {
+#if DLUTILS_ENABLE_INSTRUMENTATION
+    std::lock_guard<std::mutex> lock(mu_);
+    for (auto &stats : funStats_) {
+      stats.Reset();
+    }
+#endif
+  }
+
+  /// @brief Run hooks around the calls of a loaded function
+  ///
+  /// Every DlFun<R, Args...> bound to funName by SelfDlSym, SelfDlVSym or
+  /// SelfDlSymTable is hooked: its pointer is atomically swapped for a thunk
+  /// (see internal::DlHookTable) that calls the original target and runs the
+  /// hooks on one call in hook.sampleEvery, counted per thread. Functions
+  /// without a hook are called directly, as before. The hook is dropped when
+  /// the function is rebound, e.g. by SelfDlReload. Lazily bound functions
+  /// and generated tables cannot be hooked. The hooked DlFun objects must
+  /// still be alive. DlHook is defined in dlutils/hook.hpp.
+  ///
+  /// Each signature has DLUTILS_HOOK_SLOTS thunks, shared by the process. A
+  /// thunk is assigned to a DlFun until RemoveHook, SelfDlClose or the
+  /// destructor of this library gives it back. Copies of a hooked DlFun may
+  /// still call through its thunk, so a thunk that was given back keeps its
+  /// target and can only be reused by a function with the same target:
+  /// each signature can hook at most DLUTILS_HOOK_SLOTS distinct targets
+  /// per process. Defined in dlutils/hook.hpp.
+  ///
+  /// @tparam R The return type of the function
+  /// @tparam Args The parameter types of the function
+  /// @param funName The name of the function
+  /// @param hook The hooks to run, replacing any previous hook
+  /// @return true if a DlFun of that name and signature was hooked, false if
+  /// there is none or no thunk is free for its target
+  template <class R, class... Args>
+  bool SetHook(std::string_view funName, DlHook<R, Args...> hook);
+
+  /// @brief Remove the hooks of a function, restoring its direct calls
+  ///
+  /// The thunks are given back after a grace period, as in SelfDlReload: a
+  /// binding set is published, which waits for every ReadGuard that may
+  /// still call through them. Callers that may race with the removal must
+  /// therefore make their calls under a ReadGuard. Copies of a DlFun made
+  /// while it was hooked keep calling the same target through its thunk,
+  /// with the hooks of whichever function of that target is hooked next.
+  /// Defined in dlutils/hook.hpp.
+  ///
+  /// @param funName The name of the function
+  /// @return true if a hooked DlFun of that name was restored
+  bool RemoveHook(std::string_view funName);
+
+protected:
+  /// @brief Constructor
+  /// @param lib The name of the library to load
+  explicit DlLibBase(std::string_view lib)
+      : libName_(internal::InternName(lib)), candidates_{libName_} {
+    Enlist();
+  }
+
+  /// @brief Constructor with dlopen flags
+  /// @param lib The name of the library to load
+  /// @param flags How SelfDlOpen should load the library
+  DlLibBase(std::string_view lib, DlOpenFlags flags)
+      : libName_(internal::InternName(lib)), openFlags_(flags),
+        candidates_{libName_} {
+    Enlist();
+  }
+
+  /// @brief Constructor with an ordered list of library variants
+  ///
+  /// The variants are ordered from most to least preferred, e.g. an AVX-512
+  /// build, then an AVX2 build, then a generic one. The variants the host
+  /// does not support (see DlLibVariant::IsSupported()) are dropped here, and
+  /// SelfDlOpen loads the first remaining one that dlopen can open.
+  /// GetLoadedLib() reports which one it was. Defined in
+  /// dlutils/cpu_features.hpp, with DlLibVariant.
+  ///
+  /// @param variants The candidate libraries, most preferred first
+  /// @param flags How SelfDlOpen should load the library
+  explicit DlLibBase(const std::vector<DlLibVariant> &variants,
+                     DlOpenFlags flags = DlOpenFlags::kDefault);
+
+  /// @brief Move constructor
+  ///
+  /// Takes over the library handle and the loading state of other, which is
+  /// left closed. A pending asynchronous load of other is waited for first.
+  ///
+  /// The bindings are not taken over, since they refer to the DlFun objects
+  /// and tables of other: the hooks of other are removed, so that the
+  /// subclass copies its functions unhooked, and this object starts with an
+  /// empty, unsealed function cache and no missing symbols. The copied
+  /// functions keep calling the same targets; load the symbols again (e.g.
+  /// in the move constructor of the subclass) to seal, hook or reload them
+  /// through this object.
+  ///
+  /// NOTE: DlLazyFun objects registered with other keep resolving through
+  /// other, so wrappers with lazily bound functions should not be moved.
+  ///
+  /// @param other The library to move from
+  DlLibBase(DlLibBase &&other)
+      : libName_(other.libName_), openFlags_(other.openFlags_) {
+    Enlist();
+    other.WaitPending();
+    std::lock_guard<std::mutex> lock(other.mu_);
+    MoveFromLocked(other);
+  }
+
+  /// @brief Move assignment
+  ///
+  /// Closes the library held by this object (as SelfDlClose does, removing
+  /// its hooks), then takes over the handle and the loading state of other,
+  /// as the move constructor does.
+  ///
+  /// @param other The library to move from
+  /// @return This object
+  DlLibBase &operator=(DlLibBase &&other) {
+    if (this != &other) {
+      WaitPending();
+      other.WaitPending();
+      std::scoped_lock lock(mu_, other.mu_);
+      DropHooks();
+      ClearBindings();
+      ResetLazies();
+      CloseHandle(libptr_.exchange(nullptr, std::memory_order_acq_rel));
+      fallbacks_.reset();
+      libName_ = other.libName_;
+      openFlags_ = other.openFlags_;
+      MoveFromLocked(other);
+    }
+    return *this;
+  }
+
+  DlLibBase(const DlLibBase &) = delete;
+  DlLibBase &operator=(const DlLibBase &) = delete;
+
+  /// @brief Destructor
+  ///
+  /// Waits for a pending asynchronous load, then closes the library: its
+  /// symbols are dropped from the process-wide symbol cache and the handle is
+  /// passed to dlclose, so a wrapper that is destroyed does not keep the
+  /// library mapped. Pointers obtained from the wrapper (including copies of
+  /// its DlFun members) must not be called afterwards, unless the library
+  /// was opened with DlOpenFlags::kNoDelete, which keeps it mapped (pinned)
+  /// for the lifetime of the process. See DlLibGroup for unloading several
+  /// libraries in dependency order.
+  ///
+  /// NOTE: The loader usually binds members of the subclass, which are
+  /// destroyed before this runs, so subclasses using SelfLoadAsync should
+  /// call WaitLoaded() in their own destructor.
+  ~DlLibBase() {
+    Delist();
+    WaitPending();
+    ReleaseHooks();
+    CloseHandle(libptr_.exchange(nullptr, std::memory_order_acq_rel));
+    fallbacks_.reset();
+  }
+
+  /// @brief Load the library on a background thread
+  ///
+  /// Runs the loader, typically SelfDlOpen() followed by SelfDlSymTable(...),
+  /// on a new thread and returns immediately. Callers can then block only
+  /// when they need a function (WaitLoaded() or the returned future), or poll
+  /// IsLoaded() and take a fallback path until it is ready. Several libraries
+  /// can be preloaded in parallel this way. If a load is already pending, its
+  /// future is returned and the new loader is not run.
+  ///
+  /// @tparam Loader A callable returning bool
+  /// @param loader The function loading the library and its symbols
+  /// @return A std::shared_future<bool> holding the result of the loader
+  /// (defined in dlutils/async.hpp)
+  template <class Loader> auto SelfLoadAsync(Loader &&loader);
+
+  /// @brief Open the dynamic library
+  ///
+  /// This function uses dlopen to load the library specified in the
+  /// constructor. See: https://man7.org/linux/man-pages/man3/dlopen.3.html If
+  /// filename contains a slash ("/"), then it is interpreted as a (relative or
+  /// absolute) pathname. Otherwise, the dynamic linker searches for the object.
+  /// The library is opened with the DlOpenFlags given to the constructor
+  /// (DlOpenFlags::kDefault, i.e. RTLD_NOW | RTLD_GLOBAL, if none were given).
+  /// If the constructor was given a list of variants, the supported ones are
+  /// tried in order until one loads.
+  ///
+  /// A library that is already open is left as it is, without taking
+  /// another reference: call SelfDlClose() first to open it again, or
+  /// SelfDlReload() to switch libraries.
+  ///
+  /// @return true if the library is loaded (now or already), false if it
+  /// could not be loaded
+  bool SelfDlOpen() {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (libptr_.load(std::memory_order_relaxed) != nullptr) {
+      return true;
+    }
+    void *libptr = nullptr;
+    loadedLib_ = std::string_view();
+    for (std::string_view lib : candidates_) {
+      libptr = OpenHandle(lib);
+      if (libptr != nullptr) {
+        loadedLib_ = lib;
+        break;
+      }
+    }
+    libptr_.store(libptr, std::memory_order_release);
+    return libptr != nullptr;
+  }
+
+  /// @brief Close the dynamic library
+  ///
+  /// This drops the symbols of the library from the process-wide symbol cache
+  /// and calls dlclose. The functions bound from the library must not be
+  /// called afterwards (unless other references keep it loaded), so this must
+  /// not race with callers.
+  ///
+  /// @return true if the library was open and dlclose succeeded
+  bool SelfDlClose() {
+    std::lock_guard<std::mutex> lock(mu_);
+    fallbacks_.reset();
+    void *libptr = libptr_.exchange(nullptr, std::memory_order_acq_rel);
+    if (libptr == nullptr) {
+      return false;
+    }
+    sealed_.store(false, std::memory_order_release);
+    versions_.reset();
+    ReleaseHooks();
+    ClearBindings();
+    loadedLib_ = std::string_view();
+    manifest_.reset();
+    elfSymbols_.reset();
+    ResetLazies();
+    return CloseHandle(libptr);
+  }
+
+  /// @brief Replace the loaded library with a new one, without downtime
+  ///
+  /// This opens the new library next to the old one, switches the handle, and
+  /// runs loadSymbols to rebind the functions against it (it must rebind every
+  /// DlFun and table, typically by loading them as at start-up, but must not
+  /// call SelfDlOpen). Lazily bound functions are reset, so that they resolve
+  /// again from the new library on their next call. The function cache and
+  /// the missing symbols are reset, so they describe the new library only.
+  ///
+  /// The whole reload is published as one binding set, however many
+  /// SelfDlSym or SelfDlSymTable calls loadSymbols makes: it first waits for
+  /// every ReadGuard on the old bindings to be released, and ReadGuards
+  /// created meanwhile wait until loadSymbols has returned, so no ReadGuard
+  /// sees a mix of old and new bindings. The old handle is closed (and its
+  /// symbols dropped from the symbol cache) once that set is published.
+  /// Callers that may race with a reload must therefore make their calls
+  /// under a ReadGuard, or open the library with DlOpenFlags::kNoDelete so
+  /// that old code stays mapped. loadSymbols must not create a ReadGuard on
+  /// this library.
+  ///
+  /// NOTE: dlopen returns the already loaded handle for a name that is still
+  /// open. To load a new build of a library, pass its new path.
+  ///
+  /// @tparam Loader A callable returning bool
+  /// @param lib The library to load (SelfDlOpen opens it from now on, once
+  /// it was opened here)
+  /// @param loadSymbols Rebinds the functions, returns true on success
+  /// @return true if the new library was opened and loadSymbols returned true;
+  /// if the library cannot be opened, the old one stays loaded and SelfDlOpen
+  /// keeps opening the old names
+  template <class Loader>
+  bool SelfDlReload(std::string_view lib, Loader &&loadSymbols) {
+    std::lock_guard<std::mutex> reloadLock(reloadMu_);
+    const std::string_view interned = internal::InternName(lib);
+    return ReloadLocked(&interned, loadSymbols);
+  }
+
+  /// @brief Reload the library from the names given to the constructor
+  ///
+  /// Same as SelfDlReload(lib, loadSymbols), trying the same candidates as
+  /// SelfDlOpen.
+  ///
+  /// @tparam Loader A callable returning bool
+  /// @param loadSymbols Rebinds the functions, returns true on success
+  /// @return true if the library was opened and loadSymbols returned true
+  template <class Loader> bool SelfDlReload(Loader &&loadSymbols) {
+    std::lock_guard<std::mutex> reloadLock(reloadMu_);
+    return ReloadLocked(nullptr, loadSymbols);
+  }
+
+  /// @brief Resolve symbols through an on-disk manifest before dlsym
+  ///
+  /// Call this after SelfDlOpen and before loading symbols. From then on,
+  /// SelfDlSym, SelfDlSymTable and SelfDlLoadTable look each symbol up in
+  /// the manifest first (see DlSymbolManifest), and fall back to dlsym for
+  /// the symbols it does not hold or if it does not validate for the loaded
+  /// library. The symbols resolved by dlsym are recorded; SelfDlSaveManifest
+  /// writes them out. Versioned symbols (SelfDlVSym) and lazily bound
+  /// functions always go through dlsym.
+  ///
+  /// The manifest is dropped when the library is closed or reloaded; call
+  /// this again from the reload loader to keep using one. Defined in
+  /// dlutils/symbol_manifest.hpp.
+  ///
+  /// @param path The manifest file
+  /// @return true if the manifest was mapped and is valid for the library
+  bool SelfDlUseManifest(std::string_view path);
+
+  /// @brief Write the manifest if dlsym resolved symbols it did not hold
+  ///
+  /// Defined in dlutils/symbol_manifest.hpp.
+  ///
+  /// @return true if the manifest is up to date (written now or already
+  /// complete), false if there is none or it could not be written
+  bool SelfDlSaveManifest();
+
+  /// @brief Resolve symbols from the library's own GNU hash table first
+  ///
+  /// Call this after SelfDlOpen and before loading symbols. From then on,
+  /// SelfDlSym, SelfDlSymTable and SelfDlLoadTable look each symbol up in
+  /// the .gnu.hash and .dynsym sections of the loaded library (see
+  /// internal::DlElfSymbols) instead of calling dlsym, and SelfDlSymTable
+  /// resolves its whole table in one batch. The symbols it does not define
+  /// itself still go through dlsym. A valid manifest takes precedence.
+  ///
+  /// The lookup is dropped when the library is closed or reloaded; call this
+  /// again from the reload loader to keep using it. Defined in
+  /// dlutils/elf_symbols.hpp.
+  ///
+  /// @return true if the loaded library has a GNU hash table to use
+  bool SelfDlUseElfLookup();
+
+  /// @brief Record the dlopen calls and symbol lookups (see GetLoadReport)
+  ///
+  /// Call this before SelfDlOpen, typically from the constructor, so that
+  /// the dlopen calls are recorded too. This allocates the record buffers
+  /// once; calling it again keeps the records. Defined in
+  /// dlutils/load_report.hpp.
+  void SelfDlEnableLoadReport();
+
+  /// @brief Add a library to search for the symbols the loaded one lacks
+  ///
+  /// The fallback libraries are searched in the order they were added, after
+  /// the library SelfDlOpen loaded, by SelfDlSym, SelfDlSymTable and
+  /// SelfDlLoadTable. For example, load an accelerated engine build and add
+  /// the stock library as a fallback for what the engine does not export.
+  /// Lazily bound functions and versioned symbols only come from the loaded
+  /// library. Fallbacks are opened with the flags given to the constructor,
+  /// stay open across SelfDlReload, and are closed by SelfDlClose. Defined
+  /// in dlutils/fallback.hpp.
+  ///
+  /// @param lib The name of the fallback library
+  /// @return true if the library was opened (or is already a fallback)
+  bool SelfDlAddFallback(std::string_view lib);
+
+  /// @brief Load a symbol from the dynamic library
+  ///
+  /// This function uses dlsym to find a symbol in the loaded library and wraps
+  /// it in a DlFun object. The binding is published as a new binding set.
+  /// Lookups go through the process-wide internal::DlSymbolCache, so a symbol
+  /// that another instance already resolved from the same library does not
+  /// call dlsym again.
+  ///
+  /// Template argument deduction helper:
+  /// When the caller calls this function with the outFun argument, the C++
+  /// compiler will automatically deduce the template arguments, eliminating the
+  /// need for the caller to specify the exact template arguments.
+  ///
+  /// @tparam R The return type of the function
+  /// @tparam Args The parameter types of the function
+  /// @param funName The name of the function to load
+  /// @param outFun The DlFun object to populate with the function
+  /// @return true if the symbol lookup was attempted (even if it failed), false
+  /// if preconditions were not met
+  template <class R, class... Args>
+  bool SelfDlSym(std::string_view funName, DlFun<R, Args...> &outFun) {
+    std::lock_guard<std::mutex> lock(mu_);
+    void *libptr = libptr_.load(std::memory_order_relaxed);
+    if (libptr == nullptr || funName.empty()) {
+      return false;
+    }
+
+    funName = internal::InternName(funName);
+    void *funPtr = ResolveLogged(
+        funName, [&](auto &) { return ResolveFrom(libptr, funName); },
+        [&] { return MissingError(libptr, funName); });
+    PublishSymbol(funName, funPtr, outFun);
+    return true;
+  }
+
+  /// @brief Load a specific version of a symbol from the dynamic library
+  ///
+  /// Libraries built with symbol versioning may export several versions of
+  /// the same symbol, and dlsym always returns the default one. This tries
+  /// each of the preferred versions in order with dlvsym, and falls back to
+  /// the default version (as SelfDlSym does) if none of them is exported.
+  /// The version that got bound is reported by GetBoundVersion().
+  ///
+  /// Versioned lookups are cached like unversioned ones, and the bound DlFun
+  /// calls the chosen version directly. Without dlvsym (see
+  /// DLUTILS_HAS_DLVSYM), this always binds the default version. Defined in
+  /// dlutils/versioning.hpp.
+  ///
+  /// @tparam R The return type of the function
+  /// @tparam Args The parameter types of the function
+  /// @param funName The name of the function to load
+  /// @param versions The preferred versions, most preferred first
+  /// @param outFun The DlFun object to populate with the function
+  /// @return true if the symbol lookup was attempted (even if it failed), false
+  /// if preconditions were not met
+  template <class R, class... Args>
+  bool SelfDlVSym(std::string_view funName,
+                  const std::vector<std::string_view> &versions,
+                  DlFun<R, Args...> &outFun);
+
+  /// @brief Register a symbol to be resolved on its first call
+  ///
+  /// Unlike SelfDlSym, this does not call dlsym: the DlLazyFun resolves itself
+  /// through this library the first time it is called. Lazily bound functions
+  /// are therefore not part of the function cache, and a missing symbol is
+  /// only reported when the function is called (or bound with
+  /// DlLazyFun::Bind()).
+  ///
+  /// @tparam R The return type of the function
+  /// @tparam Args The parameter types of the function
+  /// @param funName The name of the function to load
+  /// @param outFun The DlLazyFun object to register
+  /// @return true if the function was registered, false if preconditions were
+  /// not met
+  template <class R, class... Args>
+  bool SelfDlSymLazy(std::string_view funName, DlLazyFun<R, Args...> &outFun) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (libptr_.load(std::memory_order_relaxed) == nullptr || funName.empty()) {
+      return false;
+    }
+
+    outFun.owner_ = this;
+    outFun.funName_ = internal::InternName(funName).data();
+#if DLUTILS_ENABLE_INSTRUMENTATION
+    AttachStats(outFun, funName);
+#endif
+    outFun.funptr_.store(nullptr, std::memory_order_release);
+    RegisterLazy(&outFun, [](void *fun) {
+      static_cast<DlLazyFun<R, Args...> *>(fun)->funptr_.store(
+          nullptr, std::memory_order_release);
+    });
+    return true;
+  }
+
+  /// @brief Load a whole table of symbols from the dynamic library
+  ///
+  /// The table is built at compile time from DlSymEntry objects (see the
+  /// DLUTILS_SYM_ENTRY macro). All symbols are resolved in a single pass and
+  /// the function cache is grown once, instead of once per symbol as with
+  /// repeated SelfDlSym calls. The whole table is published as one binding
+  /// set, so a ReadGuard never observes a mix of old and new bindings.
+  ///
+  /// The names of all symbols that could not be resolved are reported
+  /// together by GetMissingSymbols().
+  ///
+  /// @tparam Entries The DlSymEntry types of the table
+  /// @param entries The symbols to load
+  /// @return true if all symbols were resolved, false if any is missing or
+  /// the library is not loaded
+  template <class... Entries>
+  bool SelfDlSymTable(const Entries &...entries) {
+    std::lock_guard<std::mutex> lock(mu_);
+    void *libptr = libptr_.load(std::memory_order_relaxed);
+    if (libptr == nullptr) {
+      return false;
+    }
+
+    constexpr size_t kSize = sizeof...(Entries);
+    static_assert(kSize > 0, "The symbol table must not be empty");
+    const std::array<std::string_view, kSize> names = {
+        internal::InternName(entries.name)...};
+    std::array<void *, kSize> funPtrs = {};
+    ResolveTable(libptr, names.data(), funPtrs.data(), kSize);
+
+    ReserveBindings(kSize);
+    BeginPublish();
+    sealed_.store(false, std::memory_order_release); // Not validated yet
+    missingSyms_.clear();
+    size_t i = 0;
+    ((BindEntry(entries, names[i], funPtrs[i]), ++i), ...);
+    EndPublish();
+    return missingSyms_.empty();
+  }
+
+  /// @brief Load a symbol table generated by DLUTILS_DEFINE_SYMBOL_TABLE
+  ///
+  /// Like SelfDlSymTable, all symbols are resolved in a single pass and
+  /// published as one binding set, but the pointers are stored in the dense
+  /// array of the table instead of in separate DlFun objects. Generated tables
+  /// are not instrumented.
+  ///
+  /// @tparam Table The generated table type
+  /// @param table The table to load
+  /// @return true if all symbols were resolved, false if any is missing or
+  /// the library is not loaded
+  template <class Table> bool SelfDlLoadTable(Table &table) {
+    std::lock_guard<std::mutex> lock(mu_);
+    void *libptr = libptr_.load(std::memory_order_relaxed);
+    if (libptr == nullptr) {
+      return false;
+    }
+
+    constexpr size_t kSize = Table::kSize;
+    std::array<void *, kSize> funPtrs = {};
+    ResolveTable(libptr, Table::kNames.data(), funPtrs.data(), kSize);
+
+    ReserveBindings(kSize);
+    BeginPublish();
+    sealed_.store(false, std::memory_order_release); // Not validated yet
+    missingSyms_.clear();
+    for (size_t i = 0; i < kSize; i++) {
+      RecordBinding(&table.slots.ptrs_[i], Table::kNames[i],
+                    funPtrs[i] != nullptr, nullptr);
+      internal::AtomicStore(table.slots.ptrs_[i], funPtrs[i]);
+    }
+    EndPublish();
+    return missingSyms_.empty();
+  }
+
+  /// @brief Check if all functions in the cache were successfully loaded
+  /// @return true if all functions were successfully loaded, false otherwise
+  bool CheckFunCache() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return CheckFunCacheLocked();
+  }
+
+  /// @brief Validate all loaded functions and seal the library
+  ///
+  /// Call this once after all symbols are loaded. Loading another symbol
+  /// afterwards unseals the library again.
+  ///
+  /// @return true if all functions were successfully loaded, false otherwise
+  bool Seal() {
+    std::lock_guard<std::mutex> lock(mu_);
+    bool sealed = CheckFunCacheLocked();
+    sealed_.store(sealed, std::memory_order_release);
+    return sealed;
+  }
+
+  /// @brief Get the number of functions in the cache
+  ///
+  /// Each DlFun and table slot counts once, however often it was bound.
+  ///
+  /// @return The number of functions in the cache
+  size_t GetFunCacheSize() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return funCache_.Size();
+  }
+
+private:
+  template <class, class...> friend class DlLazyFun;
+  friend class DlLibGroup;
+  friend class internal::DlLibDirectory;
+
+  /// @brief The body of SelfDlReload (caller holds reloadMu_)
+  /// @param lib The interned library to load, which replaces the candidates
+  /// once it is open; nullptr to try the candidates
+  /// @param loadSymbols Rebinds the functions, returns true on success
+  /// @return true if the library was opened and loadSymbols returned true
+  template <class Loader>
+  bool ReloadLocked(const std::string_view *lib, Loader &loadSymbols) {
+    void *oldptr = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      void *newptr = nullptr;
+      std::string_view newLib;
+      if (lib != nullptr) {
+        newptr = OpenHandle(*lib);
+        newLib = *lib;
+      } else {
+        for (std::string_view candidate : candidates_) {
+          newptr = OpenHandle(candidate);
+          if (newptr != nullptr) {
+            newLib = candidate;
+            break;
+          }
+        }
+      }
+      if (newptr == nullptr) {
+        return false;
+      }
+      if (lib != nullptr) {
+        candidates_.assign(1, newLib);
+      }
+      // Wait for the readers of the old bindings, and hold new readers back
+      // until loadSymbols has bound the whole new set
+      BeginPublish();
+      oldptr = libptr_.exchange(newptr, std::memory_order_acq_rel);
+      loadedLib_ = newLib;
+      sealed_.store(false, std::memory_order_release);
+      ClearBindings();
+      missingSyms_.clear();
+      versions_.reset();
+      manifest_.reset();
+      elfSymbols_.reset();
+    }
+
+    bool loaded = false;
+    try {
+      loaded = loadSymbols();
+    } catch (...) {
+      FinishReload(oldptr);
+      throw;
+    }
+    FinishReload(oldptr);
+    return loaded;
+  }
+
+  /// @brief Publish the binding set of a reload and close the old handle
+  /// @param oldptr The handle of the previous library (may be nullptr)
+  void FinishReload(void *oldptr) {
+    std::lock_guard<std::mutex> lock(mu_);
+    ResetLazies();
+    // No reader of the old bindings is left: they were waited for when the
+    // reload began, and readers since then wait for this set
+    EndPublish();
+    if (oldptr != nullptr) {
+      // Reopening the same library returns the same handle, so only drop
+      // its symbols if it is really going away
+      if (oldptr != libptr_.load(std::memory_order_relaxed)) {
+        internal::DlSymbolCache::GetInstance().Invalidate(oldptr);
+      }
+      dlclose(oldptr);
+    }
+  }
+
+  /// @brief Construct the function-local statics used by the destructor
+  ///
+  /// Statics are destroyed in the reverse order of their construction, so
+  /// constructing the symbol cache first keeps it alive until a static
+  /// wrapper has been destroyed.
+  static void EnsureStaticsOutliveThis() {
+    internal::DlSymbolCache::GetInstance();
+  }
+
+  /// @brief Construct the statics, then join the list of live libraries
+  void Enlist() {
+    EnsureStaticsOutliveThis();
+    std::lock_guard<std::mutex> lock(directory_.mu);
+    prevLib_ = directory_.last;
+    (prevLib_ != nullptr ? prevLib_->nextLib_ : directory_.first) = this;
+    directory_.last = this;
+  }
+
+  /// @brief Leave the list of live libraries
+  void Delist() {
+    std::lock_guard<std::mutex> lock(directory_.mu);
+    (prevLib_ != nullptr ? prevLib_->nextLib_ : directory_.first) = nextLib_;
+    (nextLib_ != nullptr ? nextLib_->prevLib_ : directory_.last) = prevLib_;
+  }
+
+  /// @brief Wait for a pending asynchronous load, ignoring its result
+  void WaitPending() const {
+    std::shared_ptr<const internal::DlPendingLoad> pending;
+    {
+      std::lock_guard<std::mutex> lock(asyncMu_);
+      pending = pending_;
+    }
+    if (pending != nullptr) {
+      pending->Wait();
+    }
+  }
+
+  /// @brief dlopen a library with the open flags (caller holds mu_)
+  /// @param lib The interned library name
+  /// @return The handle, nullptr if dlopen failed
+  void *OpenHandle(std::string_view lib) {
+    if (loadLog_ == nullptr) {
+      return dlopen(lib.data(), ToDlOpenMode(openFlags_));
+    }
+    const uint64_t start = loadLog_->Now();
+    void *handle = dlopen(lib.data(), ToDlOpenMode(openFlags_));
+    loadLog_->RecordOpen(lib, start, handle);
+    return handle;
+  }
+
+  /// @brief Drop the cached symbols of a handle and close it
+  /// @param libptr The handle to close (may be nullptr)
+  /// @return true if the handle was open and dlclose succeeded
+  static bool CloseHandle(void *libptr) {
+    if (libptr == nullptr) {
+      return false;
+    }
+    internal::DlSymbolCache::GetInstance().Invalidate(libptr);
+    return dlclose(libptr) == 0;
+  }
+
+  /// @brief Unbind all lazily bound functions (caller holds mu_)
+  void ResetLazies() {
+    for (const auto &lazy : lazyFuns_) {
+      lazy.second(lazy.first);
+    }
+  }
+
+  /// @brief Take over the state of another library (caller holds other.mu_)
+  ///
+  /// The lazily bound functions stay registered with other. The bindings
+  /// are keyed by the addresses of the DlFun objects and tables of other, so
+  /// they are dropped instead of moved, after removing the hooks of other.
+  ///
+  /// @param other The library to move from, left closed
+  void MoveFromLocked(DlLibBase &other) {
+    libptr_.store(other.libptr_.exchange(nullptr, std::memory_order_acq_rel),
+                  std::memory_order_release);
+    candidates_ = std::exchange(other.candidates_, {});
+    loadedLib_ = std::exchange(other.loadedLib_, std::string_view());
+    other.DropHooks();
+    other.ClearBindings();
+    other.sealed_.store(false, std::memory_order_release);
+    sealed_.store(false, std::memory_order_release);
+    // The missing symbols describe the dropped bindings: rebinding them
+    // here must not count them twice
+    other.missingSyms_.clear();
+    missingSyms_.clear();
+    versions_ = std::move(other.versions_);
+    manifest_ = std::move(other.manifest_);
+    fallbacks_ = std::move(other.fallbacks_);
+    elfSymbols_ = std::move(other.elfSymbols_);
+    loadLog_ = std::move(other.loadLog_);
+    loaded_.store(other.loaded_.exchange(false), std::memory_order_release);
+    generation_.store(other.generation_.load(), std::memory_order_release);
+#if DLUTILS_ENABLE_INSTRUMENTATION
+    // Moving a deque keeps its elements in place, so the stats pointers held
+    // by the DlFun members stay valid
+    funStats_ = std::move(other.funStats_);
+#endif
+  }
+
+  /// @brief Register a lazily bound function to reset on reload
+  /// @param fun The DlLazyFun
+  /// @param reset Unbinds fun
+  void RegisterLazy(void *fun, void (*reset)(void *)) {
+    for (const auto &lazy : lazyFuns_) {
+      if (lazy.first == fun) {
+        return;
+      }
+    }
+    lazyFuns_.emplace_back(fun, reset);
+  }
+
+  /// @brief Resolve one symbol from the loaded library
+  /// @param funName The name of the symbol
+  /// @return The resolved pointer, nullptr if it is missing
+  void *ResolveSymbol(std::string_view funName) const {
+    void *libptr = libptr_.load(std::memory_order_acquire);
+    if (libptr == nullptr) {
+      return nullptr;
+    }
+    // Not through the manifest: this runs without mu_, which guards it
+    return internal::DlSymbolCache::GetInstance().Resolve(libptr, funName);
+  }
+
+  /// @brief Resolve through the manifest, then the cache (caller holds mu_)
+  /// @param libptr The handle of the loaded library
+  /// @param funName The name of the symbol (must be null-terminated)
+  /// @return The resolved pointer, nullptr if it is missing
+  void *ResolveFrom(void *libptr, std::string_view funName) const {
+    void *funPtr = manifest_ != nullptr ? manifest_->Find(funName) : nullptr;
+    if (funPtr != nullptr) {
+      return funPtr;
+    }
+    if (elfSymbols_ != nullptr) {
+      funPtr = elfSymbols_->Find(funName);
+    }
+    if (funPtr == nullptr) {
+      funPtr = internal::DlSymbolCache::GetInstance().Resolve(libptr, funName);
+    }
+    if (funPtr == nullptr) {
+      return fallbacks_ != nullptr ? fallbacks_->Find(funName) : nullptr;
+    }
+    if (manifest_ != nullptr) {
+      manifest_->Record(funName, funPtr);
+    }
+    return funPtr;
+  }
+
+  /// @brief Resolve a batch of symbols from the loaded library
+  /// @param libptr The handle of the loaded library
+  /// @param names The names of the symbols (must be null-terminated)
+  /// @param out The resolved pointers, nullptr for the missing ones
+  /// @param n The number of symbols
+  void ResolveBatch(void *libptr, const std::string_view *names, void **out,
+                    size_t n) const {
+    if (elfSymbols_ != nullptr && manifest_ == nullptr) {
+      // One pass over the hash table, then dlsym for what it did not hold
+      elfSymbols_->FindBatch(names, out, n);
+      auto &cache = internal::DlSymbolCache::GetInstance();
+      for (size_t i = 0; i < n; i++) {
+        if (out[i] == nullptr) {
+          out[i] = cache.Resolve(libptr, names[i]);
+        }
+        if (out[i] == nullptr && fallbacks_ != nullptr) {
+          out[i] = fallbacks_->Find(names[i]);
+        }
+      }
+      return;
+    }
+    for (size_t i = 0; i < n; i++) {
+      out[i] = ResolveFrom(libptr, names[i]);
+    }
+  }
+
+  /// @brief Resolve one symbol, recording it in the load log (caller holds
+  /// mu_)
+  /// @param funName The interned name of the symbol
+  /// @param resolve Resolves the symbol, returns its address or nullptr; it
+  /// is passed the name to log (funName), which it may replace
+  /// @param explain Returns why the symbol is missing, see MissingError
+  /// @return The result of resolve
+  template <class Resolve, class Explain>
+  void *ResolveLogged(std::string_view funName, Resolve &&resolve,
+                      Explain &&explain) {
+    std::string_view name = funName;
+    if (loadLog_ == nullptr) {
+      return resolve(name);
+    }
+    const uint64_t start = loadLog_->Now();
+    void *funPtr = resolve(name);
+    const uint64_t ns = loadLog_->Now() - start;
+    loadLog_->RecordSymbol(name, ns, funPtr,
+                           funPtr == nullptr ? explain() : std::string());
+    return funPtr;
+  }
+
+  /// @brief Explain why a symbol is missing, for the load log (caller holds
+  /// mu_)
+  ///
+  /// The lookup may have been answered by the symbol cache, the manifest or
+  /// the ELF hash table, without a dlsym call to read dlerror from. So the
+  /// dlsym calls that failed are made again, on the loaded library and on
+  /// each fallback, and their messages are joined with "; ".
+  ///
+  /// @param libptr The handle of the loaded library
+  /// @param funName The name of the symbol (must be null-terminated)
+  /// @return The dlerror messages
+  std::string MissingError(void *libptr, std::string_view funName) const {
+    std::string error;
+    dlerror();
+    internal::AppendDlError(error, dlsym(libptr, funName.data()) == nullptr);
+    if (fallbacks_ != nullptr) {
+      fallbacks_->ExplainMissing(funName, error);
+    }
+    return error;
+  }
+
+  /// @brief ResolveBatch, recording each symbol in the load log (caller
+  /// holds mu_)
+  /// @param libptr The handle of the loaded library
+  /// @param names The names of the symbols (interned or static)
+  /// @param out The resolved pointers, nullptr for the missing ones
+  /// @param n The number of symbols
+  void ResolveTable(void *libptr, const std::string_view *names, void **out,
+                    size_t n) {
+    if (loadLog_ == nullptr) {
+      ResolveBatch(libptr, names, out, n);
+      return;
+    }
+    const uint64_t start = loadLog_->Now();
+    ResolveBatch(libptr, names, out, n);
+    uint64_t ns = (loadLog_->Now() - start) / (n > 0 ? n : 1);
+    for (size_t i = 0; i < n; i++) {
+      loadLog_->RecordSymbol(names[i], ns, out[i],
+                             out[i] == nullptr ? MissingError(libptr, names[i])
+                                               : std::string());
+    }
+  }
+
+  /// @brief CheckFunCache without taking the lock (caller holds mu_)
+  bool CheckFunCacheLocked() const { return funCache_.AllBound(); }
+
+  /// @brief Enter a ReadGuard section, waiting out an ongoing publication
+  void EnterRead() const {
+    for (;;) {
+      uint64_t gen = generation_.load(std::memory_order_seq_cst);
+      if ((gen & 1) == 0) {
+        readers_.fetch_add(1, std::memory_order_seq_cst);
+        if (generation_.load(std::memory_order_seq_cst) == gen) {
+          return;
+        }
+        // A publication started in between, back off until it is done
+        readers_.fetch_sub(1, std::memory_order_release);
+      }
+      sched_yield();
+    }
+  }
+
+  /// @brief Leave a ReadGuard section
+  void ExitRead() const { readers_.fetch_sub(1, std::memory_order_release); }
+
+  /// @brief Start publishing a binding set (caller holds mu_)
+  ///
+  /// Makes the generation odd, so that new readers wait, and then waits for
+  /// the readers that are still using the previous set. Publications nest:
+  /// inside an outer one (a reload), this only adds to the same set.
+  void BeginPublish() {
+    if (publishDepth_++ > 0) {
+      return;
+    }
+    generation_.fetch_add(1, std::memory_order_seq_cst);
+    while (readers_.load(std::memory_order_seq_cst) != 0) {
+      sched_yield();
+    }
+  }
+
+  /// @brief Finish publishing a binding set (caller holds mu_)
+  void EndPublish() {
+    if (--publishDepth_ == 0) {
+      generation_.fetch_add(1, std::memory_order_release);
+    }
+  }
+
+  /// @brief Publish one resolved symbol as a new binding set (caller holds mu_)
+  /// @param funName The interned name of the symbol
+  /// @param funPtr The resolved pointer, nullptr if it is missing
+  /// @param outFun The DlFun object to bind
+  template <class R, class... Args>
+  void PublishSymbol(std::string_view funName, void *funPtr,
+                     DlFun<R, Args...> &outFun) {
+    BeginPublish();
+    sealed_.store(false, std::memory_order_release); // Not validated yet
+    // Failed lookups are counted too
+    RecordBinding(&outFun, funName, funPtr != nullptr,
+                  &internal::DlSignature<R, Args...>::kTag);
+#if DLUTILS_ENABLE_INSTRUMENTATION
+    AttachStats(outFun, funName);
+#endif
+    outFun.Publish(funName, reinterpret_cast<R (*)(Args...)>(funPtr));
+    EndPublish();
+  }
+
+  /// @brief Record the binding of a DlFun or table slot (caller holds mu_)
+  ///
+  /// Each target is kept once, keyed by its address: binding it again (e.g.
+  /// by calling SelfDlSym twice for the same DlFun) overwrites its entry and
+  /// its bit, instead of adding another one. A missing symbol is added to the
+  /// missing symbols, replacing the earlier failure of the same target.
+  ///
+  /// @param target The DlFun or table slot
+  /// @param name The interned name of the symbol
+  /// @param bound Whether the symbol resolved
+  /// @param signature The DlSignature tag of the DlFun, nullptr for a slot
+  void RecordBinding(void *target, std::string_view name, bool bound,
+                     const void *signature) {
+    auto [index, inserted] = bindingIndex_.Insert(target, boundFuns_.size());
+    if (inserted) {
+      funCache_.Push(bound);
+      boundFuns_.push_back(BoundFun{name.data(), target, signature, nullptr});
+    } else {
+      if (!funCache_.Test(index)) {
+        for (auto it = missingSyms_.begin(); it != missingSyms_.end(); ++it) {
+          if (*it == boundFuns_[index].name) {
+            missingSyms_.erase(it);
+            break;
+          }
+        }
+      }
+      funCache_.Set(index, bound);
+      boundFuns_[index].name = name.data(); // Keeps the hook of the target
+    }
+    if (!bound) {
+      missingSyms_.emplace_back(name);
+    }
+  }
+
+  /// @brief Reserve room for more bindings (caller holds mu_)
+  /// @param n The number of targets about to be bound
+  void ReserveBindings(size_t n) {
+    funCache_.Reserve(funCache_.Size() + n);
+    boundFuns_.reserve(boundFuns_.size() + n);
+    bindingIndex_.Reserve(boundFuns_.size() + n);
+  }
+
+  /// @brief Give back the hook thunks of the bound functions, which may
+  /// already be destroyed (caller holds mu_ or is the destructor)
+  void ReleaseHooks() {
+    if (unhook_ == nullptr) {
+      return; // Nothing was ever hooked
+    }
+    for (const auto &bound : boundFuns_) {
+      if (bound.ops != nullptr) {
+        unhook_(bound.ops, bound.fun, false);
+      }
+    }
+  }
+
+  /// @brief Unhook the bound functions and give their thunks back (caller
+  /// holds mu_)
+  ///
+  /// Unlike ReleaseHooks, this restores the direct pointers, so the bound
+  /// DlFun objects must still be alive.
+  void DropHooks() {
+    if (unhook_ == nullptr) {
+      return; // Nothing was ever hooked
+    }
+    for (const auto &bound : boundFuns_) {
+      if (bound.ops != nullptr) {
+        unhook_(bound.ops, bound.fun, true);
+      }
+    }
+  }
+
+  /// @brief Forget all bindings (caller holds mu_)
+  void ClearBindings() {
+    funCache_.Clear();
+    boundFuns_.clear();
+    bindingIndex_.Clear();
+  }
+
+  /// @brief Bind one resolved symbol table entry
+  /// @param entry The entry to bind
+  /// @param name The interned name of the entry
+  /// @param funPtr The resolved pointer, nullptr if it is missing
+  template <class R, class... Args>
+  void BindEntry(const DlSymEntry<R, Args...> &entry, std::string_view name,
+                 void *funPtr) {
+    RecordBinding(entry.fun, name, funPtr != nullptr,
+                  &internal::DlSignature<R, Args...>::kTag);
+#if DLUTILS_ENABLE_INSTRUMENTATION
+    AttachStats(*entry.fun, name);
+#endif
+    entry.fun->Publish(name, reinterpret_cast<R (*)(Args...)>(funPtr));
+  }
+
+#if DLUTILS_ENABLE_INSTRUMENTATION
+  /// @brief Attach the call statistics of a symbol to a function wrapper
+  ///
+  /// The statistics are kept per symbol name, so rebinding a function keeps
+  /// its counters. (caller holds mu_)
+  ///
+  /// @param fun The DlFun or DlLazyFun to attach to
+  /// @param funName The name of the symbol
+  template <class Fun> void AttachStats(Fun &fun, std::string_view funName) {
+    internal::DlFunStats *stats = nullptr;
+    for (auto &s : funStats_) {
+      if (s.GetName() == funName) {
+        stats = &s;
+        break;
+      }
+    }
+    if (stats == nullptr) {
+      stats = &funStats_.emplace_back(std::string(funName));
+    }
+    if (fun.stats_ != stats) {
+      fun.stats_ = stats;
+    }
+  }
+#endif
+
+  std::atomic<void *> libptr_{
+      nullptr}; ///< Handle to the loaded library (default: nullptr)
+  std::string_view libName_ =
+      "unknown"; ///< The interned name of the library (default: "unknown")
+  DlOpenFlags openFlags_ =
+      DlOpenFlags::kDefault; ///< How to open the library (default: kDefault)
+
+  /// @brief The interned names SelfDlOpen tries, in order
+  std::vector<std::string_view> candidates_;
+  std::string_view loadedLib_; ///< The library SelfDlOpen loaded
+
+  /// @brief Whether each symbol loaded into a DlFun or table resolved
+  internal::DlBindingBits funCache_;
+
+  std::atomic<bool> sealed_{
+      false}; ///< Whether Seal() validated the cache (default: false)
+
+  std::vector<std::string> missingSyms_; ///< Names of unresolved symbols
+
+  /// @brief The versions bound by SelfDlVSym (see dlutils/versioning.hpp)
+  std::unique_ptr<internal::DlLibExtension> versions_;
+
+  /// @brief A DlFun or table slot bound by the loading functions
+  struct BoundFun {
+    const char *name;      ///< The interned name of the symbol
+    void *fun;             ///< The DlFun or table slot
+    const void *signature; ///< Its DlSignature tag, nullptr for a slot
+    /// @brief The hook operations of its DlHookTable once SetHook hooked it
+    const internal::DlHookOps *ops;
+  };
+
+  /// @brief The bound targets, in first binding order; target i has bit i
+  /// of funCache_ (see SetHook)
+  std::vector<BoundFun> boundFuns_;
+
+  /// @brief The index of each bound target in boundFuns_, by address
+  internal::DlTargetIndex bindingIndex_;
+
+  /// @brief Unhooks a bound DlFun through its ops, restoring its direct
+  /// pointer first if the last argument is true; set by SetHook
+  void (*unhook_)(const internal::DlHookOps *, void *, bool) = nullptr;
+
+  /// @brief The symbol manifest bound to the loaded library, if any
+  std::unique_ptr<internal::DlSymbolSource> manifest_;
+
+  /// @brief The fallback libraries (see dlutils/fallback.hpp)
+  std::unique_ptr<internal::DlSymbolSource> fallbacks_;
+
+  /// @brief The GNU hash table of the loaded library (SelfDlUseElfLookup)
+  std::unique_ptr<internal::DlSymbolSource> elfSymbols_;
+
+  /// @brief The record of the loading functions (SelfDlEnableLoadReport)
+  std::unique_ptr<internal::DlLoadRecorder> loadLog_;
+
+  mutable std::mutex mu_; ///< Serializes the loading functions
+  std::mutex reloadMu_;   ///< Serializes SelfDlReload
+
+  /// @brief The lazily bound functions and their reset functions
+  std::vector<std::pair<void *, void (*)(void *)>> lazyFuns_;
+
+  mutable std::mutex asyncMu_; ///< Guards pending_
+  /// @brief The last asynchronous load (SelfLoadAsync)
+  std::shared_ptr<const internal::DlPendingLoad> pending_;
+  std::atomic<bool> loaded_{false}; ///< Whether the async load succeeded
+
+  /// @brief Binding set generation, odd while a set is being published
+  std::atomic<uint64_t> generation_{0};
+
+  /// @brief The nesting depth of BeginPublish (guarded by mu_)
+  size_t publishDepth_ = 0;
+
+  /// @brief Number of live ReadGuard sections
+  mutable std::atomic<uint64_t> readers_{0};
+
+  static inline internal::DlLibList directory_; ///< The live libraries
+  DlLibBase *prevLib_ = nullptr; ///< The previous entry of directory_
+  DlLibBase *nextLib_ = nullptr; ///< The next entry of directory_
+
+#if DLUTILS_ENABLE_INSTRUMENTATION
+  /// @brief Call statistics of each symbol name (stable addresses)
+  std::deque<internal::DlFunStats> funStats_;
+#endif
+};
+
+template <class R, class... Args>
+typename DlLazyFun<R, Args...>::FunTy DlLazyFun<R, Args...>::Bind() const {
+  if (owner_ == nullptr) {
+    return nullptr;
+  }
+  FunTy funptr = reinterpret_cast<FunTy>(owner_->ResolveSymbol(funName_));
+  if (funptr != nullptr) {
+    funptr_.store(funptr, std::memory_order_release);
+  }
+  return funptr;
+}
+
+/// @brief Macro to simplify loading symbols from dynamic libraries
+///
+/// This macro simplifies the process of loading symbols by automatically
+/// converting the function name to a string and passing it to SelfDlSym.
+/// The second argument acts as a template helper, allowing the compiler
+/// to automatically deduce the template arguments for SelfDlSym.
+///
+/// Usage: DLUTILS_SELF_DLSYM(function_name)
+/// Expands to: SelfDlSym("function_name", function_name)
+#define DLUTILS_SELF_DLSYM(NAME) SelfDlSym(#NAME, NAME)
+
+/// @brief Macro to simplify registering lazily bound symbols
+///
+/// Usage: DLUTILS_SELF_DLSYM_LAZY(function_name)
+/// Expands to: SelfDlSymLazy("function_name", function_name)
+#define DLUTILS_SELF_DLSYM_LAZY(NAME) SelfDlSymLazy(#NAME, NAME)
+
+/// @brief Macro to create a symbol table entry for SelfDlSymTable
+///
+/// Usage: SelfDlSymTable(DLUTILS_SYM_ENTRY(fun_a), DLUTILS_SYM_ENTRY(fun_b))
+/// Expands each entry to: dlutils::MakeDlSymEntry("fun_a", fun_a)
+#define DLUTILS_SYM_ENTRY(NAME) ::dlutils::MakeDlSymEntry(#NAME, NAME)
+
+/// @brief Implementation details of DLUTILS_DEFINE_SYMBOL_TABLE
+#define DLUTILS_INTERNAL_TABLE_INDEX(NAME, R, PARAMS) k##NAME,
+#define DLUTILS_INTERNAL_TABLE_NAME(NAME, R, PARAMS) std::string_view(#NAME),
+#define DLUTILS_INTERNAL_TABLE_CALL(NAME, R, PARAMS)                           \
+  template <class... CallArgs> R NAME(CallArgs &&...args) const {              \
+    return slots.Call<R PARAMS>(k##NAME, kNames[k##NAME],                      \
+                                std::forward<CallArgs>(args)...);              \
+  }
+
+/// @brief Macro to generate a symbol table from a single declaration list
+///
+/// LIST is an X-macro taking one macro argument X, which it applies to every
+/// symbol as X(name, return type, (parameter types)). From it, this defines
+/// a struct TABLE with
+/// - an enumerator k<name> per symbol, and kSize,
+/// - kNames, a constexpr array of the symbol names,
+/// - slots, the dense array of resolved pointers (see DlSymbolSlots),
+/// - a member function <name>(args...) per symbol, which calls the symbol
+///   and throws std::runtime_error if it is not loaded.
+///
+/// Load the table with DlLibBase::SelfDlLoadTable(). Usage:
+///
+///   #define MY_SYMBOLS(X) X(fun_a, int, (int, int)) X(fun_b, void, ())
+///   DLUTILS_DEFINE_SYMBOL_TABLE(MySymbols, MY_SYMBOLS);
+#define DLUTILS_DEFINE_SYMBOL_TABLE(TABLE, LIST)                              \
+  struct TABLE {                                                               \
+    enum : size_t { LIST(DLUTILS_INTERNAL_TABLE_INDEX) kSize };                \
+    static constexpr std::array<std::string_view, kSize> kNames = {            \
+        LIST(DLUTILS_INTERNAL_TABLE_NAME)};                                    \
+    LIST(DLUTILS_INTERNAL_TABLE_CALL)                                          \
+    ::dlutils::DlSymbolSlots<kSize> slots;                                     \
+  }
+
+} // namespace dlutils
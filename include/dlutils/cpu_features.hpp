@@ -0,0 +1,148 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+#include "dlutils/core.hpp"
+
+namespace dlutils {
+
+/// @brief CPU features a library variant may require
+///
+/// Combine them with operator|. HasCpuFeatures() checks them against the host
+/// with cpuid on x86 (through __builtin_cpu_supports, which also accounts for
+/// the OS enabling the AVX state) and with getauxval(AT_HWCAP) on AArch64
+/// Linux. Features of another architecture are never supported.
+enum class DlCpuFeatures : unsigned {
+  kNone = 0,           ///< No requirement, supported everywhere
+  kSse42 = 1u << 0,    ///< x86 SSE4.2
+  kAvx = 1u << 1,      ///< x86 AVX
+  kAvx2 = 1u << 2,     ///< x86 AVX2
+  kFma = 1u << 3,      ///< x86 FMA3
+  kAvx512f = 1u << 4,  ///< x86 AVX-512 Foundation
+  kAvx512bw = 1u << 5, ///< x86 AVX-512 Byte and Word
+  kAvx512vl = 1u << 6, ///< x86 AVX-512 Vector Length
+  kNeon = 1u << 16,    ///< AArch64 Advanced SIMD
+  kSve = 1u << 17,     ///< AArch64 Scalable Vector Extension
+};
+
+/// @brief Combine two sets of DlCpuFeatures
+inline constexpr DlCpuFeatures operator|(DlCpuFeatures a, DlCpuFeatures b) {
+  return static_cast<DlCpuFeatures>(static_cast<unsigned>(a) |
+                                    static_cast<unsigned>(b));
+}
+
+/// @brief Intersect two sets of DlCpuFeatures
+inline constexpr DlCpuFeatures operator&(DlCpuFeatures a, DlCpuFeatures b) {
+  return static_cast<DlCpuFeatures>(static_cast<unsigned>(a) &
+                                    static_cast<unsigned>(b));
+}
+
+namespace internal {
+
+/// @brief Detect the CPU features of the host
+/// @return The supported features
+inline DlCpuFeatures DetectCpuFeatures() {
+  DlCpuFeatures features = DlCpuFeatures::kNone;
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+  __builtin_cpu_init();
+  auto add = [&features](bool supported, DlCpuFeatures feature) {
+    if (supported) {
+      features = features | feature;
+    }
+  };
+  add(__builtin_cpu_supports("sse4.2"), DlCpuFeatures::kSse42);
+  add(__builtin_cpu_supports("avx"), DlCpuFeatures::kAvx);
+  add(__builtin_cpu_supports("avx2"), DlCpuFeatures::kAvx2);
+  add(__builtin_cpu_supports("fma"), DlCpuFeatures::kFma);
+  add(__builtin_cpu_supports("avx512f"), DlCpuFeatures::kAvx512f);
+  add(__builtin_cpu_supports("avx512bw"), DlCpuFeatures::kAvx512bw);
+  add(__builtin_cpu_supports("avx512vl"), DlCpuFeatures::kAvx512vl);
+#elif defined(__aarch64__) && defined(__linux__)
+  // The AArch64 HWCAP bits, see <asm/hwcap.h>
+  constexpr unsigned long kHwcapAsimd = 1ul << 1;
+  constexpr unsigned long kHwcapSve = 1ul << 22;
+  unsigned long hwcap = getauxval(AT_HWCAP);
+  if ((hwcap & kHwcapAsimd) != 0) {
+    features = features | DlCpuFeatures::kNeon;
+  }
+  if ((hwcap & kHwcapSve) != 0) {
+    features = features | DlCpuFeatures::kSve;
+  }
+#endif
+  return features;
+}
+
+} // namespace internal
+
+/// @brief Get the CPU features of the host (detected once)
+/// @return The supported features
+inline DlCpuFeatures GetCpuFeatures() {
+  static const DlCpuFeatures features = internal::DetectCpuFeatures();
+  return features;
+}
+
+/// @brief Check whether the host supports a set of CPU features
+/// @param required The features to check
+/// @return true if all of them are supported
+inline bool HasCpuFeatures(DlCpuFeatures required) {
+  return (GetCpuFeatures() & required) == required;
+}
+
+/// @brief One build of a library, and what it needs from the host
+///
+/// Used by the DlLibBase constructor taking a candidate list: the first
+/// variant that the host supports (and that dlopen can load) is loaded.
+struct DlLibVariant {
+  std::string_view lib; ///< The name of the library to load
+  DlCpuFeatures required = DlCpuFeatures::kNone; ///< The required features
+  bool (*predicate)() = nullptr; ///< An extra check (ignored if nullptr)
+
+  /// @brief Check whether the host can run this variant
+  /// @return true if the features are supported and the predicate holds
+  bool IsSupported() const {
+    return HasCpuFeatures(required) && (predicate == nullptr || predicate());
+  }
+};
+
+inline DlLibBase::DlLibBase(const std::vector<DlLibVariant> &variants,
+                            DlOpenFlags flags)
+    : openFlags_(flags) {
+  Enlist();
+  for (const auto &variant : variants) {
+    if (variant.IsSupported()) {
+      candidates_.push_back(internal::InternName(variant.lib));
+    }
+  }
+  if (!candidates_.empty()) {
+    libName_ = candidates_.front(); // "unknown" if none is supported
+  }
+}
+
+} // namespace dlutils
@@ -0,0 +1,283 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <dlfcn.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+#include "dlutils/core.hpp"
+
+/// @brief Whether symbols can be looked up in the GNU hash table directly
+///
+/// This needs dlinfo and the ELF definitions of <link.h>, which are GNU
+/// extensions. Without them, DlLibBase::SelfDlUseElfLookup has no effect.
+#ifndef DLUTILS_HAS_ELF_LOOKUP
+#if defined(__GLIBC__) && defined(_GNU_SOURCE)
+#define DLUTILS_HAS_ELF_LOOKUP 1
+#else
+#define DLUTILS_HAS_ELF_LOOKUP 0
+#endif
+#endif
+
+#if DLUTILS_HAS_ELF_LOOKUP
+#include <elf.h>
+#include <link.h>
+#endif
+
+namespace dlutils {
+
+namespace internal {
+
+/// @brief The dynamic symbol table of one loaded object
+///
+/// dlsym takes the loader lock and walks the search scope of the handle on
+/// every call. This looks names up straight in the .gnu.hash and .dynsym
+/// sections of the object behind a handle: the Bloom filter rejects most
+/// missing names with one load, and a hit costs a bucket and a short chain
+/// walk. No lock is taken.
+///
+/// Only plain definitions of the object itself are returned: functions and
+/// data with a default (non-hidden) version. Lookup() returns nullptr for
+/// everything else, such as IFUNC and TLS symbols and the symbols of the
+/// dependencies, which callers then resolve with dlsym.
+class DlElfSymbols : public DlSymbolSource {
+public:
+  /// @brief The GNU hash of a symbol name
+  /// @param name The symbol name
+  /// @return The hash
+  static constexpr uint32_t Hash(std::string_view name) {
+    uint32_t h = 5381;
+    for (char c : name) {
+      h = h * 33 + static_cast<unsigned char>(c);
+    }
+    return h;
+  }
+
+  /// @brief Find the symbol tables of the object behind a handle
+  /// @param handle The library handle
+  /// @return true if the object has a GNU hash table
+  bool Open(void *handle) {
+    *this = DlElfSymbols();
+#if DLUTILS_HAS_ELF_LOOKUP
+    struct link_map *lm = nullptr;
+    if (handle == nullptr || dlinfo(handle, RTLD_DI_LINKMAP, &lm) != 0 ||
+        lm == nullptr || lm->l_ld == nullptr) {
+      return false;
+    }
+    const uintptr_t base = static_cast<uintptr_t>(lm->l_addr);
+    // The loader relocates most dynamic entries in place, but not where the
+    // dynamic section is read-only; unrelocated ones are offsets
+    auto address = [base](ElfW(Addr) ptr) {
+      return static_cast<uintptr_t>(ptr) < base
+                 ? base + static_cast<uintptr_t>(ptr)
+                 : static_cast<uintptr_t>(ptr);
+    };
+    const uint32_t *gnuHash = nullptr;
+    for (const ElfW(Dyn) *dyn = lm->l_ld; dyn->d_tag != DT_NULL; ++dyn) {
+      switch (dyn->d_tag) {
+      case DT_GNU_HASH:
+        gnuHash = reinterpret_cast<const uint32_t *>(address(dyn->d_un.d_ptr));
+        break;
+      case DT_SYMTAB:
+        symtab_ = reinterpret_cast<const ElfW(Sym) *>(address(dyn->d_un.d_ptr));
+        break;
+      case DT_STRTAB:
+        strtab_ = reinterpret_cast<const char *>(address(dyn->d_un.d_ptr));
+        break;
+      case DT_VERSYM:
+        versym_ = reinterpret_cast<const uint16_t *>(address(dyn->d_un.d_ptr));
+        break;
+      default:
+        break;
+      }
+    }
+    if (gnuHash == nullptr || symtab_ == nullptr || strtab_ == nullptr ||
+        gnuHash[0] == 0 || gnuHash[2] == 0) {
+      *this = DlElfSymbols();
+      return false;
+    }
+    base_ = base;
+    nbuckets_ = gnuHash[0];
+    symoffset_ = gnuHash[1];
+    bloomSize_ = gnuHash[2];
+    bloomShift_ = gnuHash[3];
+    bloom_ = reinterpret_cast<const ElfW(Addr) *>(gnuHash + 4);
+    buckets_ = reinterpret_cast<const uint32_t *>(bloom_ + bloomSize_);
+    chain_ = buckets_ + nbuckets_;
+    return true;
+#else
+    (void)handle;
+    return false;
+#endif
+  }
+
+  /// @brief Check whether Open() found the symbol tables
+  /// @return true if lookups can succeed
+  bool IsOpen() const { return buckets_ != nullptr; }
+
+  /// @brief Look up a symbol defined by the object
+  /// @param name The symbol name
+  /// @return The symbol address, nullptr if it is not a plain definition of
+  /// the object (resolve it with dlsym then)
+  void *Lookup(std::string_view name) const {
+    return LookupHashed(name, Hash(name));
+  }
+
+  /// @brief Look up a batch of symbols
+  ///
+  /// The hashes are computed and filtered through the Bloom filter for the
+  /// whole batch first, and the buckets of the candidates prefetched, so the
+  /// chain walks of the batch overlap their cache misses.
+  ///
+  /// @param names The symbol names
+  /// @param out The symbol addresses, nullptr for the ones not found
+  /// @param n The number of symbols
+  void LookupBatch(const std::string_view *names, void **out, size_t n) const {
+    constexpr size_t kChunk = 32;
+    uint32_t hashes[kChunk];
+    for (size_t begin = 0; begin < n; begin += kChunk) {
+      const size_t end = begin + kChunk < n ? begin + kChunk : n;
+      for (size_t i = begin; i < end; i++) {
+        uint32_t h = Hash(names[i]);
+        hashes[i - begin] = h;
+#if defined(__GNUC__)
+        if (IsOpen() && MayContain(h)) {
+          __builtin_prefetch(&buckets_[h % nbuckets_]);
+        }
+#endif
+      }
+      for (size_t i = begin; i < end; i++) {
+        out[i] = LookupHashed(names[i], hashes[i - begin]);
+      }
+    }
+  }
+
+  /// @brief Same as Lookup()
+  void *Find(std::string_view name) const override { return Lookup(name); }
+
+  /// @brief Same as LookupBatch()
+  void FindBatch(const std::string_view *names, void **out,
+                 size_t n) const override {
+    LookupBatch(names, out, n);
+  }
+
+private:
+#if DLUTILS_HAS_ELF_LOOKUP
+  /// @brief The number of bits of a Bloom filter word
+  static constexpr uint32_t kBloomBits = sizeof(ElfW(Addr)) * 8;
+#endif
+
+  /// @brief Test the Bloom filter (false means the name is missing)
+  bool MayContain(uint32_t h) const {
+#if DLUTILS_HAS_ELF_LOOKUP
+    const ElfW(Addr) word = bloom_[(h / kBloomBits) % bloomSize_];
+    const ElfW(Addr) mask =
+        (ElfW(Addr){1} << (h % kBloomBits)) |
+        (ElfW(Addr){1} << ((h >> bloomShift_) % kBloomBits));
+    return (word & mask) == mask;
+#else
+    (void)h;
+    return false;
+#endif
+  }
+
+  /// @brief Look up a symbol whose hash is known
+  void *LookupHashed(std::string_view name, uint32_t h) const {
+#if DLUTILS_HAS_ELF_LOOKUP
+    if (!IsOpen() || !MayContain(h)) {
+      return nullptr;
+    }
+    uint32_t index = buckets_[h % nbuckets_];
+    if (index < symoffset_) {
+      return nullptr;
+    }
+    for (;; index++) {
+      const uint32_t chainHash = chain_[index - symoffset_];
+      if ((chainHash | 1) == (h | 1) && IsDefinition(index) &&
+          std::strncmp(strtab_ + symtab_[index].st_name, name.data(),
+                       name.size()) == 0 &&
+          strtab_[symtab_[index].st_name + name.size()] == '\0') {
+        return reinterpret_cast<void *>(base_ + symtab_[index].st_value);
+      }
+      if ((chainHash & 1) != 0) {
+        return nullptr; // The end of the chain
+      }
+    }
+#else
+    (void)name;
+    (void)h;
+    return nullptr;
+#endif
+  }
+
+#if DLUTILS_HAS_ELF_LOOKUP
+  /// @brief Check whether a symbol is a plain, default-version definition
+  bool IsDefinition(uint32_t index) const {
+    const ElfW(Sym) &sym = symtab_[index];
+    // st_info has the same layout in ELF32 and ELF64
+    const unsigned type = ELF64_ST_TYPE(sym.st_info);
+    const unsigned bind = ELF64_ST_BIND(sym.st_info);
+    if (sym.st_shndx == SHN_UNDEF || sym.st_value == 0 ||
+        (bind != STB_GLOBAL && bind != STB_WEAK) ||
+        (type != STT_FUNC && type != STT_OBJECT && type != STT_NOTYPE)) {
+      return false;
+    }
+    // Index 0 is local, and the hidden bit marks non-default versions
+    return versym_ == nullptr ||
+           ((versym_[index] & 0x8000) == 0 && versym_[index] != 0);
+  }
+
+  const ElfW(Sym) *symtab_ = nullptr;  ///< .dynsym
+  const char *strtab_ = nullptr;       ///< .dynstr
+  const uint16_t *versym_ = nullptr;   ///< .gnu.version, if any
+  const ElfW(Addr) *bloom_ = nullptr;  ///< The Bloom filter words
+#endif
+  uintptr_t base_ = 0;               ///< The load bias of the object
+  uint32_t nbuckets_ = 0;            ///< The number of hash buckets
+  uint32_t symoffset_ = 0;           ///< The first hashed symbol index
+  uint32_t bloomSize_ = 0;           ///< The number of Bloom filter words
+  uint32_t bloomShift_ = 0;          ///< The second Bloom hash shift
+  const uint32_t *buckets_ = nullptr; ///< The hash buckets
+  const uint32_t *chain_ = nullptr;   ///< The hash chains
+};
+
+} // namespace internal
+
+inline bool DlLibBase::SelfDlUseElfLookup() {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto symbols = std::make_unique<internal::DlElfSymbols>();
+  if (!symbols->Open(libptr_.load(std::memory_order_relaxed))) {
+    elfSymbols_.reset();
+    return false;
+  }
+  elfSymbols_ = std::move(symbols);
+  return true;
+}
+
+} // namespace dlutils
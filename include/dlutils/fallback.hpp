@@ -0,0 +1,124 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <dlfcn.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "dlutils/core.hpp"
+
+namespace dlutils {
+
+namespace internal {
+
+/// @brief The fallback libraries of a DlLibBase, searched in order
+///
+/// They are opened by DlLibBase::SelfDlAddFallback and closed (their cached
+/// symbols dropped first) when this is destroyed.
+class DlFallbackLibs : public DlSymbolSource {
+public:
+  DlFallbackLibs() = default;
+  DlFallbackLibs(const DlFallbackLibs &) = delete;
+  DlFallbackLibs &operator=(const DlFallbackLibs &) = delete;
+
+  /// @brief Destructor, closes the libraries
+  ~DlFallbackLibs() override {
+    auto &cache = DlSymbolCache::GetInstance();
+    for (const auto &lib : libs) {
+      cache.Invalidate(lib.second);
+      dlclose(lib.second);
+    }
+  }
+
+  /// @brief Resolve a symbol from the first library that has it
+  /// @param name The symbol name (null-terminated)
+  /// @return The symbol address, nullptr if no library has it
+  void *Find(std::string_view name) const override {
+    auto &cache = DlSymbolCache::GetInstance();
+    for (const auto &lib : libs) {
+      if (void *ptr = cache.Resolve(lib.second, name)) {
+        return ptr;
+      }
+    }
+    return nullptr;
+  }
+
+  /// @brief Add the dlsym error of each library to a load report error
+  /// @param name The symbol name (null-terminated)
+  /// @param error The error so far
+  void ExplainMissing(std::string_view name,
+                      std::string &error) const override {
+    for (const auto &lib : libs) {
+      AppendDlError(error, dlsym(lib.second, name.data()) == nullptr);
+    }
+  }
+
+  /// @brief The interned names and handles of the libraries
+  std::vector<std::pair<std::string_view, void *>> libs;
+};
+
+} // namespace internal
+
+inline bool DlLibBase::SelfDlAddFallback(std::string_view lib) {
+  std::lock_guard<std::mutex> lock(mu_);
+  lib = internal::InternName(lib);
+  void *handle = OpenHandle(lib);
+  if (handle == nullptr) {
+    return false;
+  }
+  if (fallbacks_ == nullptr) {
+    fallbacks_ = std::make_unique<internal::DlFallbackLibs>();
+  }
+  auto &libs = static_cast<internal::DlFallbackLibs &>(*fallbacks_).libs;
+  for (const auto &fallback : libs) {
+    if (fallback.second == handle) {
+      dlclose(handle); // Drop the extra reference
+      return true;
+    }
+  }
+  libs.emplace_back(lib, handle);
+  return true;
+}
+
+inline std::vector<std::string_view> DlLibBase::GetFallbackLibs() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  std::vector<std::string_view> libs;
+  if (fallbacks_ == nullptr) {
+    return libs;
+  }
+  const auto &fallbacks =
+      static_cast<const internal::DlFallbackLibs &>(*fallbacks_).libs;
+  libs.reserve(fallbacks.size());
+  for (const auto &fallback : fallbacks) {
+    libs.push_back(fallback.first);
+  }
+  return libs;
+}
+
+} // namespace dlutils
@@ -0,0 +1,207 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace dlutils {
+
+/// @brief Internal utilities for string creation
+///
+/// These functions are used internally to create strings from various types
+/// and combinations of arguments. This header does not depend on iostreams;
+/// MakeString, which can also format any streamable type, lives in
+/// make_string.hpp.
+namespace internal {
+
+/// @brief Whether T is formatted as a single character
+template <typename T>
+inline constexpr bool kIsCharLike =
+    std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+    std::is_same_v<T, unsigned char>;
+
+/// @brief Whether T is an integer FormatTo can format (at most 64 bits)
+template <typename T>
+inline constexpr bool kIsFastInteger =
+    std::is_integral_v<T> && sizeof(T) <= sizeof(uint64_t);
+
+/// @brief Whether FormatTo formats T as a hexadecimal address
+///
+/// Pointers to signed or unsigned char are excluded, since operator<< prints
+/// them as strings, and so are function pointers, which it prints as bool.
+template <typename T, bool = std::is_pointer_v<T>>
+inline constexpr bool kIsFastPointer = false;
+
+template <typename T>
+inline constexpr bool kIsFastPointer<T, true> =
+    !kIsCharLike<std::remove_cv_t<std::remove_pointer_t<T>>> &&
+    !std::is_function_v<std::remove_pointer_t<T>>;
+
+/// @brief Whether FormatTo can format T (and MakeString needs no stringstream)
+///
+/// These are strings (anything convertible to std::string_view), characters,
+/// bool, integers of up to 64 bits, floating point numbers and object
+/// pointers. For other types, MakeString (see make_string.hpp) falls back to
+/// operator<< on a std::stringstream.
+template <typename T>
+inline constexpr bool kIsFastFormattable =
+    std::is_convertible_v<const T &, std::string_view> ||
+    kIsFastInteger<T> || std::is_floating_point_v<T> || kIsFastPointer<T>;
+
+/// @brief The maximum number of characters FormatTo writes for a number
+///
+/// This fits every number kIsFastFormattable accepts (at most 20 digits and
+/// a sign for an integer, 14 characters for a floating point number with 6
+/// significant digits), so std::to_chars cannot run out of room.
+inline constexpr size_t kMaxNumberChars = 32;
+
+/// @brief Get an upper bound of the formatted size of a value
+///
+/// The bound is exact for strings and a compile-time constant for the other
+/// fast-formattable types.
+///
+/// @param t The value to format
+/// @return The maximum number of characters FormatTo writes for t
+template <typename T> inline size_t FormatBound(const T &t) {
+  if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+    return std::string_view(t).size();
+  } else if constexpr (kIsCharLike<T> || std::is_same_v<T, bool>) {
+    return 1;
+  } else {
+    return kMaxNumberChars;
+  }
+}
+
+/// @brief Format a value into a buffer of at least FormatBound(t) characters
+///
+/// The output matches what operator<< on a default std::stringstream writes:
+/// bool as 0/1, floating point numbers with 6 significant digits, and
+/// pointers in hexadecimal.
+///
+/// @param out The buffer to write to
+/// @param t The value to format
+/// @return The end of the written characters
+template <typename T> inline char *FormatTo(char *out, const T &t) {
+  static_assert(kIsFastFormattable<T>,
+                "FormatTo only supports strings, numbers and pointers");
+  if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+    std::string_view sv(t);
+    std::memcpy(out, sv.data(), sv.size());
+    return out + sv.size();
+  } else if constexpr (kIsCharLike<T>) {
+    *out = static_cast<char>(t);
+    return out + 1;
+  } else if constexpr (std::is_same_v<T, bool>) {
+    *out = t ? '1' : '0';
+    return out + 1;
+  } else if constexpr (std::is_integral_v<T>) {
+    return std::to_chars(out, out + kMaxNumberChars, t).ptr;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return std::to_chars(out, out + kMaxNumberChars, t,
+                         std::chars_format::general, 6)
+        .ptr;
+  } else {
+    auto value = reinterpret_cast<uintptr_t>(t);
+    if (value == 0) {
+      *out = '0';
+      return out + 1;
+    }
+    out[0] = '0';
+    out[1] = 'x';
+    return std::to_chars(out + 2, out + kMaxNumberChars, value, 16).ptr;
+  }
+}
+
+/// @brief Creates a string from strings, characters, numbers and pointers
+///
+/// The arguments are formatted with std::to_chars into a string whose size is
+/// computed up front, so at most one allocation is made (none if the result
+/// fits the small string buffer). This is the iostream-free core of
+/// MakeString, used for the diagnostics of the core headers.
+///
+/// @tparam Args The types of the arguments
+/// @param args The arguments to format
+/// @return A string containing all arguments converted to string form
+template <typename... Args> std::string FormatString(const Args &...args) {
+  static_assert((kIsFastFormattable<Args> && ...),
+                "FormatString only supports strings, numbers and pointers");
+  std::string out((FormatBound(args) + ... + size_t{0}), '\0');
+  char *end = out.data();
+  ((end = FormatTo(end, args)), ...);
+  out.resize(static_cast<size_t>(end - out.data()));
+  return out;
+}
+
+/// @brief Formats multiple arguments into a caller-provided buffer
+///
+/// This never allocates. The output is truncated to fit the buffer and is
+/// always null-terminated (if size > 0). Only fast-formattable argument types
+/// are accepted.
+///
+/// @tparam Args The types of the arguments
+/// @param buf The buffer to write to
+/// @param size The size of the buffer
+/// @param args The arguments to format
+/// @return The number of characters written, excluding the terminator
+template <typename... Args>
+size_t MakeStringTo(char *buf, size_t size, const Args &...args) {
+  static_assert((kIsFastFormattable<Args> && ...),
+                "MakeStringTo only supports strings, numbers and pointers");
+  if (size == 0) {
+    return 0;
+  }
+  size_t pos = 0;
+  auto append = [buf, size, &pos](const auto &t) {
+    const size_t room = size - 1 - pos;
+    if (FormatBound(t) <= room) {
+      pos = static_cast<size_t>(FormatTo(buf + pos, t) - buf);
+    } else {
+      // Format into a stack buffer first (or copy the string directly) and
+      // keep what fits
+      std::string_view sv;
+      char tmp[kMaxNumberChars];
+      if constexpr (std::is_convertible_v<decltype(t), std::string_view>) {
+        sv = std::string_view(t);
+      } else {
+        sv = std::string_view(tmp,
+                              static_cast<size_t>(FormatTo(tmp, t) - tmp));
+      }
+      const size_t n = sv.size() < room ? sv.size() : room;
+      std::memcpy(buf + pos, sv.data(), n);
+      pos += n;
+    }
+  };
+  (append(args), ...);
+  buf[pos] = '\0';
+  return pos;
+}
+
+} // namespace internal
+
+} // namespace dlutils
@@ -0,0 +1,363 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "dlutils/core.hpp"
+
+/// @brief The number of distinct DlFun objects of one signature that can be
+/// hooked per process (see DlLibBase::SetHook)
+#ifndef DLUTILS_HOOK_SLOTS
+#define DLUTILS_HOOK_SLOTS 16
+#endif
+
+namespace dlutils {
+
+namespace internal {
+
+/// @brief The post hook type of DlHook: it also sees a non-void result
+template <class R, class... Args> struct DlHookPost {
+  using type = std::function<void(const R &, const Args &...)>;
+};
+
+template <class... Args> struct DlHookPost<void, Args...> {
+  using type = std::function<void(const Args &...)>;
+};
+
+} // namespace internal
+
+/// @brief Hooks run around the calls of a DlFun (see DlLibBase::SetHook)
+///
+/// Either hook may be empty. The hooks see the arguments by const reference;
+/// pre may throw to inject a fault, the target is then not called.
+///
+/// @tparam R The return type of the function
+/// @tparam Args The parameter types of the function
+template <class R, class... Args> struct DlHook {
+  /// @brief The type of the post hook, which also sees a non-void result
+  using PostFn = typename internal::DlHookPost<R, Args...>::type;
+
+  std::function<void(const Args &...)> pre; ///< Runs before the target
+  PostFn post;                              ///< Runs after the target
+  uint32_t sampleEvery = 1; ///< Run the hooks on 1 call in sampleEvery
+};
+
+namespace internal {
+
+/// @brief Call a target between the hooks of a DlHook
+/// @param hook The DlHook<R, Args...>
+/// @param target The original target
+/// @param args The arguments of the call
+/// @return The result of the target
+template <class R, class... Args>
+R RunDlHook(const void *hook, R (*target)(Args...), Args &...args) {
+  const auto &h = *static_cast<const DlHook<R, Args...> *>(hook);
+  if (h.pre) {
+    h.pre(args...);
+  }
+  // The post hook sees the arguments after the call, so they are only moved
+  // into the target without one
+  if constexpr (std::is_void_v<R>) {
+    if (!h.post) {
+      return target(std::forward<Args>(args)...);
+    }
+    target(args...);
+    h.post(args...);
+  } else {
+    if (!h.post) {
+      return target(std::forward<Args>(args)...);
+    }
+    R result = target(args...);
+    h.post(result, args...);
+    return result;
+  }
+}
+
+/// @brief The type-erased operations of a DlHookTable, which DlLibBase keeps
+/// with each hooked DlFun
+struct DlHookOps {
+  /// @brief Remove the hook of a DlFun, see DlHookTable::Remove
+  bool (*remove)(void *fun);
+  /// @brief Give the thunk of a DlFun back, see DlHookTable::Release
+  void (*release)(const void *fun);
+};
+
+/// @brief The call thunks of one function signature
+///
+/// Hooking a DlFun swaps its pointer for one of DLUTILS_HOOK_SLOTS statically
+/// generated thunks of its signature. The thunk finds its slot by its index,
+/// calls the original target, and runs the hooks on sampled calls through
+/// the type-erased runner of the slot (RunDlHook). Unhooked functions are
+/// never routed through a thunk, so they pay nothing.
+///
+/// A slot stays assigned to its DlFun when the hook is removed, until the
+/// owning DlLibBase releases it after a grace period (see
+/// DlLibBase::RemoveHook), or when the DlFun is closed or destroyed. Copies
+/// of a hooked DlFun (and DlUncheckedFun adapters) may still hold the thunk
+/// pointer, so a slot is never retargeted once it was used: a released slot
+/// keeps its target for good, and is only reassigned to a DlFun bound to
+/// that same target. Install fails when no such slot and no unused one is
+/// left. Sampling counts calls per thread, so it needs no shared counter.
+///
+/// @tparam R The return type of the function
+/// @tparam Args The parameter types of the function
+template <class R, class... Args> class DlHookTable {
+public:
+  /// @brief The function pointer type
+  using FunTy = R (*)(Args...);
+
+  /// @brief Calls the target between the hooks of a type-erased hook object
+  using Runner = R (*)(const void *hook, FunTy target, Args &...args);
+
+  /// @brief The number of thunks
+  static constexpr size_t kSlots = DLUTILS_HOOK_SLOTS;
+
+  /// @brief The type-erased operations of this signature
+  static constexpr DlHookOps kOps = {&DlHookTable::Remove,
+                                     &DlHookTable::Release};
+
+  /// @brief Route the calls of a DlFun through a thunk running hook
+  ///
+  /// Hooking a function that is already hooked replaces the hook.
+  ///
+  /// @param fun The function to hook
+  /// @param hook The hook object, passed to run
+  /// @param run Calls the target between the hooks
+  /// @param sampleEvery Run the hooks on 1 call in sampleEvery
+  /// @return false if the function is not loaded or no thunk of the
+  /// signature is free for its target
+  static bool Install(DlFun<R, Args...> &fun, std::shared_ptr<const void> hook,
+                      Runner run, uint32_t sampleEvery) {
+    std::lock_guard<std::mutex> lock(mu_);
+    FunTy current = AtomicLoad(fun.funptr_);
+    if (current == nullptr) {
+      return false;
+    }
+    Slot *slot = FindSlot(&fun, current);
+    if (slot == nullptr) {
+      return false;
+    }
+    FunTy thunk = Thunks()[static_cast<size_t>(slot - slots_.data())];
+    if (current != thunk) {
+      // Only a slot that was never used, or that already has this target
+      slot->target.store(current, std::memory_order_release);
+    }
+    slot->fun = &fun;
+    slot->sampleEvery.store(sampleEvery > 0 ? sampleEvery : 1,
+                            std::memory_order_relaxed);
+    slot->run.store(run, std::memory_order_relaxed);
+    std::atomic_store_explicit(&slot->hook, std::move(hook),
+                               std::memory_order_release);
+    AtomicStore(fun.funptr_, thunk);
+    return true;
+  }
+
+  /// @brief Restore the original target of a hooked DlFun
+  /// @param fun The DlFun<R, Args...> to unhook
+  /// @return true if the function was hooked
+  static bool Remove(void *fun) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto *dlfun = static_cast<DlFun<R, Args...> *>(fun);
+    for (size_t i = 0; i < kSlots; i++) {
+      Slot &slot = slots_[i];
+      if (slot.fun != dlfun) {
+        continue;
+      }
+      std::atomic_store_explicit(&slot.hook, std::shared_ptr<const void>(),
+                                 std::memory_order_release);
+      if (AtomicLoad(dlfun->funptr_) != Thunks()[i]) {
+        return false; // Rebound since, which dropped the hook
+      }
+      AtomicStore(dlfun->funptr_,
+                  slot.target.load(std::memory_order_relaxed));
+      return true;
+    }
+    return false;
+  }
+
+  /// @brief Free the slot of a DlFun, so that a function with the same
+  /// target can use it
+  ///
+  /// The DlFun is not accessed, so it may already be destroyed. Calls that
+  /// still go through the thunk (from copies, or callers that loaded the
+  /// thunk pointer before it was unhooked) keep reaching the target, which
+  /// the slot keeps for good.
+  ///
+  /// @param fun The DlFun<R, Args...> whose slot to free
+  static void Release(const void *fun) {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (Slot &slot : slots_) {
+      if (slot.fun == fun) {
+        std::atomic_store_explicit(&slot.hook, std::shared_ptr<const void>(),
+                                   std::memory_order_release);
+        slot.fun = nullptr;
+        return;
+      }
+    }
+  }
+
+private:
+  /// @brief The state of one thunk
+  struct Slot {
+    const void *fun = nullptr;          ///< The DlFun the slot belongs to
+    std::atomic<FunTy> target{nullptr}; ///< The original target
+    std::atomic<uint32_t> sampleEvery{1}; ///< The sampling period
+    std::atomic<Runner> run{nullptr};     ///< Runs the hook
+    std::shared_ptr<const void> hook;     ///< Atomically accessed
+  };
+
+  /// @brief Get the slot of a DlFun, assigning a free one (caller holds mu_)
+  ///
+  /// A released slot is only reassigned to a function with the same target,
+  /// and is preferred over a slot that was never used, so that unused slots
+  /// last. If the DlFun was rebound to another target since its slot was
+  /// assigned, that slot is released (keeping its old target) and another
+  /// one is assigned.
+  ///
+  /// @param fun The DlFun
+  /// @param current The current pointer of the DlFun
+  /// @return The slot, nullptr if none is free for the target
+  static Slot *FindSlot(const void *fun, FunTy current) {
+    Slot *unused = nullptr;
+    Slot *released = nullptr;
+    for (size_t i = 0; i < kSlots; i++) {
+      Slot &slot = slots_[i];
+      FunTy target = slot.target.load(std::memory_order_relaxed);
+      if (slot.fun == fun) {
+        if (current == Thunks()[i] || target == current) {
+          return &slot;
+        }
+        // Copies made while it was hooked still call the old target
+        std::atomic_store_explicit(&slot.hook, std::shared_ptr<const void>(),
+                                   std::memory_order_release);
+        slot.fun = nullptr;
+      }
+      if (slot.fun != nullptr) {
+        continue;
+      }
+      if (target == nullptr && unused == nullptr) {
+        unused = &slot;
+      } else if (target == current && released == nullptr) {
+        released = &slot;
+      }
+    }
+    return released != nullptr ? released : unused;
+  }
+
+  /// @brief The thunk of slot I
+  template <size_t I> static R Thunk(Args... args) {
+    Slot &slot = slots_[I];
+    FunTy target = slot.target.load(std::memory_order_acquire);
+    thread_local uint32_t calls = 0;
+    if (++calls >= slot.sampleEvery.load(std::memory_order_relaxed)) {
+      calls = 0;
+      auto hook = std::atomic_load_explicit(&slot.hook,
+                                            std::memory_order_acquire);
+      if (hook != nullptr) {
+        return slot.run.load(std::memory_order_relaxed)(hook.get(), target,
+                                                        args...);
+      }
+    }
+    return target(std::forward<Args>(args)...);
+  }
+
+  /// @brief Get the thunks, indexed by slot
+  static const std::array<FunTy, kSlots> &Thunks() {
+    static const std::array<FunTy, kSlots> thunks =
+        MakeThunks(std::make_index_sequence<kSlots>());
+    return thunks;
+  }
+
+  template <size_t... I>
+  static std::array<FunTy, kSlots> MakeThunks(std::index_sequence<I...>) {
+    return {{&Thunk<I>...}};
+  }
+
+  static inline std::mutex mu_;                   ///< Guards the slots
+  static inline std::array<Slot, kSlots> slots_; ///< The slots
+};
+
+/// @brief Unhook a bound DlFun, see DlLibBase::unhook_
+/// @param ops The hook operations of its DlHookTable
+/// @param fun The DlFun
+/// @param restore Whether to restore its direct pointer first (the DlFun
+/// must then still be alive)
+inline void UnhookDlFun(const DlHookOps *ops, void *fun, bool restore) {
+  if (restore) {
+    ops->remove(fun);
+  }
+  ops->release(fun);
+}
+
+} // namespace internal
+
+template <class R, class... Args>
+bool DlLibBase::SetHook(std::string_view funName, DlHook<R, Args...> hook) {
+  std::lock_guard<std::mutex> lock(mu_);
+  const char *name = internal::InternName(funName).data();
+  using Table = internal::DlHookTable<R, Args...>;
+  const uint32_t sampleEvery = hook.sampleEvery;
+  auto shared = std::make_shared<const DlHook<R, Args...>>(std::move(hook));
+  unhook_ = &internal::UnhookDlFun;
+  bool hooked = false;
+  for (auto &bound : boundFuns_) {
+    if (bound.name == name &&
+        bound.signature == &internal::DlSignature<R, Args...>::kTag) {
+      bound.ops = &Table::kOps;
+      hooked |= Table::Install(*static_cast<DlFun<R, Args...> *>(bound.fun),
+                               shared, &internal::RunDlHook<R, Args...>,
+                               sampleEvery);
+    }
+  }
+  return hooked;
+}
+
+inline bool DlLibBase::RemoveHook(std::string_view funName) {
+  std::lock_guard<std::mutex> lock(mu_);
+  const char *name = internal::InternName(funName).data();
+  bool removed = false;
+  for (const auto &bound : boundFuns_) {
+    if (bound.name == name && bound.ops != nullptr) {
+      removed |= bound.ops->remove(bound.fun);
+    }
+  }
+  if (removed) {
+    BeginPublish(); // The grace period of the thunks
+    EndPublish();
+    for (const auto &bound : boundFuns_) {
+      if (bound.name == name && bound.ops != nullptr) {
+        bound.ops->release(bound.fun);
+      }
+    }
+  }
+  return removed;
+}
+
+} // namespace dlutils
@@ -0,0 +1,247 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief Per-symbol call instrumentation
+///
+/// Define DLUTILS_ENABLE_INSTRUMENTATION to 1 (for every translation unit of
+/// the program) to make DlFun and DlLazyFun count their calls and record their
+/// latency. When it is 0 (the default), the instrumentation is compiled out
+/// entirely: DlFun has no extra member and its call operator is unchanged.
+#ifndef DLUTILS_ENABLE_INSTRUMENTATION
+#define DLUTILS_ENABLE_INSTRUMENTATION 0
+#endif
+
+#if DLUTILS_ENABLE_INSTRUMENTATION
+#include <chrono>
+#endif
+
+namespace dlutils {
+
+/// @brief Aggregated call statistics of one loaded function
+///
+/// Returned by DlLibBase::GetCallStats(). Latencies are bucketed by powers of
+/// two: latencyNs[i] counts the calls that took [2^i, 2^(i+1)) nanoseconds
+/// (bucket 0 also holds calls under one nanosecond, the last bucket holds
+/// everything above).
+struct DlCallStats {
+  /// @brief The number of latency histogram buckets
+  static constexpr size_t kLatencyBuckets = 32;
+
+  std::string name;   ///< The name of the function
+  uint64_t calls = 0; ///< The number of calls
+  uint64_t totalNs = 0; ///< The total time spent in the function
+  std::array<uint64_t, kLatencyBuckets> latencyNs = {}; ///< Latency histogram
+};
+
+namespace internal {
+
+#if DLUTILS_ENABLE_INSTRUMENTATION
+/// @brief The per-symbol call counters, sharded by thread
+///
+/// Each thread that calls the function gets a shard of its own, on its own
+/// cache line, so that threads calling the same function never contend on
+/// the same counters. Only the owning thread writes a shard, so recording a
+/// call is a few plain loads and stores, without read-modify-write atomics.
+/// The shards are summed when the statistics are read, and are kept after
+/// their thread exits (a later thread may reuse them).
+///
+/// The owning thread finds its shard through a small thread-local cache,
+/// keyed by an id that is never reused, so the lock of the shard list is
+/// only taken on a cache miss.
+class DlFunStats {
+public:
+  /// @brief The number of entries of the thread-local shard cache
+  static constexpr size_t kThreadCache = 16;
+
+  /// @brief Constructor
+  /// @param name The name of the function
+  explicit DlFunStats(std::string name)
+      : name_(std::move(name)), id_(NextId()) {}
+
+  DlFunStats(const DlFunStats &) = delete;
+  DlFunStats &operator=(const DlFunStats &) = delete;
+
+  /// @brief Get the function name
+  /// @return The name of the function
+  const std::string &GetName() const { return name_; }
+
+  /// @brief Record one call on the shard of the calling thread
+  /// @param ns The latency of the call in nanoseconds
+  void Record(uint64_t ns) {
+    Shard &shard = LocalShard();
+    Add(shard.calls, 1);
+    Add(shard.totalNs, ns);
+    Add(shard.latencyNs[Bucket(ns)], 1);
+  }
+
+  /// @brief Aggregate the shards
+  /// @return The statistics of the function since the last Reset()
+  DlCallStats Aggregate() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    DlCallStats stats = SumLocked();
+    stats.name = name_;
+    stats.calls -= base_.calls;
+    stats.totalNs -= base_.totalNs;
+    for (size_t i = 0; i < DlCallStats::kLatencyBuckets; i++) {
+      stats.latencyNs[i] -= base_.latencyNs[i];
+    }
+    return stats;
+  }
+
+  /// @brief Reset all counters to zero
+  ///
+  /// The shards are only written by their threads, so this records the
+  /// current sums as the new zero instead of clearing them.
+  void Reset() {
+    std::lock_guard<std::mutex> lock(mu_);
+    base_ = SumLocked();
+  }
+
+private:
+  /// @brief The counters of one thread
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> totalNs{0};
+    std::array<std::atomic<uint64_t>, DlCallStats::kLatencyBuckets>
+        latencyNs = {};
+    const void *owner = nullptr; ///< The thread token of the owning thread
+  };
+
+  /// @brief Add to a counter that only the calling thread writes
+  static void Add(std::atomic<uint64_t> &counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+  }
+
+  /// @brief Get a process-wide unique id for a new DlFunStats
+  static uint64_t NextId() {
+    static std::atomic<uint64_t> nextId{1};
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// @brief Get the shard of the calling thread, through the thread cache
+  Shard &LocalShard() {
+    struct CacheEntry {
+      uint64_t id = 0;        ///< The id of the cached DlFunStats
+      Shard *shard = nullptr; ///< Its shard for this thread
+    };
+    thread_local std::array<CacheEntry, kThreadCache> cache;
+    CacheEntry &entry = cache[id_ % kThreadCache];
+    if (entry.id != id_) {
+      entry.shard = &FindShard();
+      entry.id = id_;
+    }
+    return *entry.shard;
+  }
+
+  /// @brief Find or create the shard of the calling thread
+  Shard &FindShard() {
+    // Unique among the live threads; a thread that reuses the address of an
+    // exited one also takes over its shard
+    thread_local const char token = 0;
+    std::lock_guard<std::mutex> lock(mu_);
+    for (auto &shard : shards_) {
+      if (shard->owner == &token) {
+        return *shard;
+      }
+    }
+    shards_.push_back(std::make_unique<Shard>());
+    shards_.back()->owner = &token;
+    return *shards_.back();
+  }
+
+  /// @brief Sum the counters of all shards (caller holds mu_)
+  DlCallStats SumLocked() const {
+    DlCallStats stats;
+    for (const auto &shard : shards_) {
+      stats.calls += shard->calls.load(std::memory_order_relaxed);
+      stats.totalNs += shard->totalNs.load(std::memory_order_relaxed);
+      for (size_t i = 0; i < DlCallStats::kLatencyBuckets; i++) {
+        stats.latencyNs[i] +=
+            shard->latencyNs[i].load(std::memory_order_relaxed);
+      }
+    }
+    return stats;
+  }
+
+  /// @brief Get the histogram bucket of a latency
+  static size_t Bucket(uint64_t ns) {
+    size_t bucket = 0;
+    while (ns > 1 && bucket + 1 < DlCallStats::kLatencyBuckets) {
+      ns >>= 1;
+      bucket++;
+    }
+    return bucket;
+  }
+
+  std::string name_;                           ///< The name of the function
+  const uint64_t id_;                          ///< Never reused, see NextId()
+  mutable std::mutex mu_;                      ///< Guards shards_ and base_
+  std::vector<std::unique_ptr<Shard>> shards_; ///< One shard per thread
+  DlCallStats base_;                           ///< The sums at the last Reset()
+};
+
+/// @brief Records the latency of one call when it goes out of scope
+class DlCallTimer {
+public:
+  /// @brief Start timing a call
+  /// @param stats The statistics to record into (nullptr: nothing is timed)
+  explicit DlCallTimer(DlFunStats *stats) : stats_(stats) {
+    if (stats_ != nullptr) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  /// @brief Stop timing and record the call
+  ~DlCallTimer() {
+    if (stats_ != nullptr) {
+      auto elapsed = std::chrono::steady_clock::now() - start_;
+      stats_->Record(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+              .count()));
+    }
+  }
+
+  DlCallTimer(const DlCallTimer &) = delete;
+  DlCallTimer &operator=(const DlCallTimer &) = delete;
+
+private:
+  DlFunStats *stats_; ///< The statistics to record into
+  std::chrono::steady_clock::time_point start_; ///< The start of the call
+};
+#endif
+
+} // namespace internal
+
+} // namespace dlutils
@@ -0,0 +1,246 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dlutils/core.hpp"
+#include "dlutils/name_pool.hpp"
+
+/// @brief Whether dladdr is available (a GNU and BSD extension)
+#ifndef DLUTILS_HAS_DLADDR
+#if defined(_GNU_SOURCE) || defined(__APPLE__)
+#define DLUTILS_HAS_DLADDR 1
+#else
+#define DLUTILS_HAS_DLADDR 0
+#endif
+#endif
+
+/// @brief The number of records kept per library by a load report
+#ifndef DLUTILS_LOAD_REPORT_CAPACITY
+#define DLUTILS_LOAD_REPORT_CAPACITY 1024
+#endif
+
+/// @brief The bytes of dlerror text kept per library by a load report
+#ifndef DLUTILS_LOAD_REPORT_TEXT
+#define DLUTILS_LOAD_REPORT_TEXT 65536
+#endif
+
+namespace dlutils {
+
+/// @brief One dlopen attempt of a load report
+struct DlOpenReport {
+  std::string lib;   ///< The library passed to dlopen
+  uint64_t ns = 0;   ///< The time spent in dlopen
+  std::string error; ///< The dlerror() message, empty if dlopen succeeded
+};
+
+/// @brief One symbol resolution of a load report
+struct DlSymbolReport {
+  std::string name; ///< The symbol name ("name@version" for SelfDlVSym)
+  uint64_t ns = 0;  ///< The time spent resolving the symbol
+  /// The path of the object the symbol was found in (per dladdr, which may
+  /// name a dependency or a fallback library), empty if it is missing
+  std::string object;
+  std::string error; ///< The dlsym error message, empty if it was found
+};
+
+/// @brief What loading a library did, in order
+///
+/// Returned by DlLibBase::GetLoadReport() for libraries that called
+/// SelfDlEnableLoadReport. The symbols of one SelfDlSymTable or
+/// SelfDlLoadTable call are resolved in a single pass, whose time is shared
+/// equally between them.
+struct DlLoadReport {
+  std::vector<DlOpenReport> opens;     ///< The dlopen attempts
+  std::vector<DlSymbolReport> symbols; ///< The symbol resolutions
+  size_t dropped = 0; ///< The records that did not fit the buffer
+};
+
+namespace internal {
+
+/// @brief A preallocated log of the dlopen calls and symbol lookups of a
+/// library
+///
+/// The buffer holds DLUTILS_LOAD_REPORT_CAPACITY records, and the dlerror
+/// messages are copied into a text buffer of DLUTILS_LOAD_REPORT_TEXT bytes.
+/// Both are allocated once, by the constructor. Records past the capacity are
+/// counted but not kept, and messages past the text capacity are truncated.
+/// Symbol and library names are views of interned or static names, and the
+/// object paths are interned (see DlNamePool): recording a found symbol only
+/// allocates when its object's path was not interned yet, which happens once
+/// per object. Only the loading functions record, so calling a
+/// bound function costs nothing.
+class DlLoadLog : public DlLoadRecorder {
+public:
+  /// @brief The number of records kept
+  static constexpr size_t kCapacity = DLUTILS_LOAD_REPORT_CAPACITY;
+
+  /// @brief The number of bytes of dlerror text kept
+  static constexpr size_t kTextCapacity = DLUTILS_LOAD_REPORT_TEXT;
+
+  /// @brief The clock timing the records
+  using Clock = std::chrono::steady_clock;
+
+  /// @brief Constructor, allocates the buffers
+  DlLoadLog()
+      : records_(std::make_unique<Record[]>(kCapacity)),
+        text_(std::make_unique<char[]>(kTextCapacity)) {}
+
+  /// @brief Read the clock timing the records
+  /// @return The time since the epoch of Clock, in nanoseconds
+  uint64_t Now() const override {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch())
+            .count());
+  }
+
+  /// @brief Record a dlopen call, read dlerror() right after it
+  /// @param lib The library passed to dlopen
+  /// @param start When dlopen was called, per Now()
+  /// @param handle The result of dlopen
+  void RecordOpen(std::string_view lib, uint64_t start,
+                  const void *handle) override {
+    uint64_t ns = Now() - start;
+    const char *message = handle == nullptr ? dlerror() : nullptr;
+    std::string_view error =
+        message != nullptr ? CopyText(message) : std::string_view();
+    Push(Record{lib, std::string_view(), error, ns, true});
+  }
+
+  /// @brief Record a symbol lookup
+  /// @param name The name of the symbol (interned or static)
+  /// @param ns The time spent resolving it
+  /// @param ptr The resolved address, nullptr if it is missing
+  /// @param error Why a missing symbol is missing (see
+  /// DlLibBase::MissingError), empty if it was found
+  void RecordSymbol(std::string_view name, uint64_t ns, const void *ptr,
+                    std::string_view error) override {
+    if (size_ < kCapacity) {
+      error = CopyText(error);
+    }
+    Push(Record{name, ObjectOf(ptr), error, ns, false});
+  }
+
+  /// @brief Copy the records into a report
+  /// @return The report
+  DlLoadReport Report() const {
+    DlLoadReport report;
+    report.dropped = dropped_;
+    for (size_t i = 0; i < size_; i++) {
+      const Record &record = records_[i];
+      if (record.isOpen) {
+        report.opens.push_back(DlOpenReport{std::string(record.name),
+                                            record.ns,
+                                            std::string(record.error)});
+      } else {
+        report.symbols.push_back(DlSymbolReport{
+            std::string(record.name), record.ns, std::string(record.object),
+            std::string(record.error)});
+      }
+    }
+    return report;
+  }
+
+private:
+  /// @brief One record, holding views of interned names and text_ only
+  struct Record {
+    std::string_view name;   ///< The library or symbol name
+    std::string_view object; ///< The object path of a found symbol
+    std::string_view error;  ///< The dlerror message, in text_
+    uint64_t ns;             ///< The elapsed time
+    bool isOpen;             ///< Whether this is a dlopen record
+  };
+
+  /// @brief Copy a message into the text buffer, truncated to what is left
+  /// @param text The message
+  /// @return The copy, empty if there is no message or no room
+  std::string_view CopyText(std::string_view text) {
+    if (text.empty()) {
+      return std::string_view();
+    }
+    size_t size = std::min(text.size(), kTextCapacity - textSize_);
+    char *copy = text_.get() + textSize_;
+    std::memcpy(copy, text.data(), size);
+    textSize_ += size;
+    return std::string_view(copy, size);
+  }
+
+  /// @brief Append a record, or count it as dropped if the buffer is full
+  void Push(const Record &record) {
+    if (size_ < kCapacity) {
+      records_[size_++] = record;
+    } else {
+      dropped_++;
+    }
+  }
+
+  /// @brief Get the path of the object containing an address
+  static std::string_view ObjectOf(const void *ptr) {
+#if DLUTILS_HAS_DLADDR
+    Dl_info info;
+    if (ptr != nullptr && dladdr(ptr, &info) != 0 &&
+        info.dli_fname != nullptr) {
+      return InternName(info.dli_fname);
+    }
+#endif
+    return ptr != nullptr ? std::string_view("unknown") : std::string_view();
+  }
+
+  std::unique_ptr<Record[]> records_; ///< The buffer, kCapacity records
+  std::unique_ptr<char[]> text_;      ///< The messages, kTextCapacity bytes
+  size_t size_ = 0;                   ///< The number of records kept
+  size_t textSize_ = 0;               ///< The bytes of text_ used
+  size_t dropped_ = 0;                ///< The number of records dropped
+};
+
+} // namespace internal
+
+inline void DlLibBase::SelfDlEnableLoadReport() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (loadLog_ == nullptr) {
+    loadLog_ = std::make_unique<internal::DlLoadLog>();
+  }
+}
+
+inline DlLoadReport DlLibBase::GetLoadReport() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  // loadLog_ only ever holds the DlLoadLog made above
+  return loadLog_ != nullptr
+             ? static_cast<const internal::DlLoadLog &>(*loadLog_).Report()
+             : DlLoadReport();
+}
+
+} // namespace dlutils
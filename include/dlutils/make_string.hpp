@@ -0,0 +1,139 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dlutils/format.hpp"
+
+namespace dlutils {
+
+namespace internal {
+
+/// @brief Base case for recursive MakeStringInternal template
+inline void MakeStringInternal(std::stringstream & /*ss*/) {}
+
+/// @brief Appends a single value to a stringstream
+/// @tparam T The type of the value to append
+/// @param ss The stringstream to append to
+/// @param t The value to append
+template <typename T>
+inline void MakeStringInternal(std::stringstream &ss, const T &t) {
+  ss << t;
+}
+
+/// @brief Specialization for stringstream objects
+/// @param ss The stringstream to append to
+/// @param t The stringstream whose content will be appended
+template <>
+inline void MakeStringInternal(std::stringstream &ss,
+                               const std::stringstream &t) {
+  ss << t.str();
+}
+
+/// @brief Recursively appends multiple values to a stringstream
+/// @tparam T The type of the first value to append
+/// @tparam Args The types of the remaining values to append
+/// @param ss The stringstream to append to
+/// @param t The first value to append
+/// @param args The remaining values to append
+template <typename T, typename... Args>
+inline void MakeStringInternal(std::stringstream &ss, const T &t,
+                               const Args &...args) {
+  MakeStringInternal(ss, t);
+  MakeStringInternal(ss, args...);
+}
+
+/// @brief Creates a string from multiple arguments of various types
+///
+/// Strings, characters, numbers and pointers are formatted with
+/// std::to_chars into a string whose size is computed up front, so at most
+/// one allocation is made (none if the result fits the small string buffer).
+/// Any other argument type makes the call fall back to a std::stringstream.
+///
+/// @tparam Args The types of the arguments
+/// @param args The arguments to convert to string
+/// @return A string containing all arguments converted to string form
+template <typename... Args> std::string MakeString(const Args &...args) {
+  if constexpr ((kIsFastFormattable<Args> && ...)) {
+    return FormatString(args...);
+  } else {
+    std::stringstream ss;
+    MakeStringInternal(ss, args...);
+    return std::string(ss.str());
+  }
+}
+
+/// @brief Creates a string from vector elements with optional delimiter
+/// @tparam T The type of elements in the vector
+/// @param v The vector of elements to convert to string
+/// @param delim The delimiter to use between elements (default: space)
+/// @return A string containing all vector elements separated by the delimiter
+template <typename T>
+std::string MakeString(const std::vector<T> &v,
+                       const std::string &delim = " ") {
+  if constexpr (kIsFastFormattable<T>) {
+    size_t bound = v.empty() ? 0 : delim.size() * (v.size() - 1);
+    for (const auto &e : v) {
+      bound += FormatBound(static_cast<const T &>(e));
+    }
+    std::string out(bound, '\0');
+    char *end = out.data();
+    for (auto it = v.begin(); it < v.end(); it++) {
+      if (it != v.begin()) {
+        end = FormatTo(end, delim);
+      }
+      end = FormatTo(end, static_cast<const T &>(*it));
+    }
+    out.resize(static_cast<size_t>(end - out.data()));
+    return out;
+  } else {
+    std::stringstream ss;
+    for (auto it = v.begin(); it < v.end(); it++) {
+      if (it != v.begin()) {
+        MakeStringInternal(ss, delim);
+      }
+      MakeStringInternal(ss, *it);
+    }
+    return std::string(ss.str());
+  }
+}
+
+// Specializations for already-a-string types.
+/// @brief Specialization for std::string objects
+/// @param str The string to return
+/// @return The input string
+template <> inline std::string MakeString(const std::string &str) {
+  return str;
+}
+
+/// @brief Specialization for C-style strings
+/// @param cstr The C-style string to convert
+/// @return A std::string containing the same content
+inline std::string MakeString(const char *cstr) { return std::string(cstr); }
+
+} // namespace internal
+
+} // namespace dlutils
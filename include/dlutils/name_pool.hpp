@@ -0,0 +1,156 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace dlutils {
+
+namespace internal {
+
+/// @brief Process-wide pool of interned symbol and library names
+///
+/// DlFun, DlLazyFun and DlLibBase store their names as std::string_view into
+/// this pool instead of owning a std::string each. Every distinct name is
+/// stored once for the lifetime of the process, so wrappers of the same
+/// symbol (in any number of DlLibBase instances) share one copy, and reading
+/// a name never allocates.
+///
+/// Interned views are stable and null-terminated, so they can be passed to
+/// dlopen and dlsym directly. Names are never removed: the pool only grows
+/// with the number of distinct names, which is bounded by the program.
+///
+/// The names are copied into large chunks and indexed by an open-addressing
+/// table, which keeps <unordered_set> and <deque> out of the core header.
+class DlNamePool {
+public:
+  /// @brief Get the process-wide pool
+  /// @return The pool instance
+  static DlNamePool &GetInstance() {
+    static DlNamePool instance;
+    return instance;
+  }
+
+  DlNamePool(const DlNamePool &) = delete;
+  DlNamePool &operator=(const DlNamePool &) = delete;
+
+  /// @brief Intern a name
+  /// @param name The name to intern
+  /// @return A stable, null-terminated view of the pooled copy of name
+  std::string_view Intern(std::string_view name) {
+    const size_t hash = std::hash<std::string_view>()(name);
+    std::lock_guard<std::mutex> lock(mu_);
+    if (2 * (size_ + 1) > slots_.size()) {
+      Grow();
+    }
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      Slot &slot = slots_[i];
+      if (slot.name.data() == nullptr) {
+        slot = Slot{hash, Store(name)};
+        size_++;
+        return slot.name;
+      }
+      if (slot.hash == hash && slot.name == name) {
+        return slot.name;
+      }
+    }
+  }
+
+  /// @brief Get the number of interned names
+  /// @return The number of distinct names in the pool
+  size_t Size() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return size_;
+  }
+
+private:
+  DlNamePool() = default;
+
+  /// @brief An entry of the index, empty if name is null
+  struct Slot {
+    size_t hash = 0;       ///< The hash of the name
+    std::string_view name; ///< A view into the chunks
+  };
+
+  /// @brief The size of a chunk of names
+  static constexpr size_t kChunkSize = 4096;
+
+  /// @brief Double the index, keeping it at most half full (caller holds mu_)
+  void Grow() {
+    std::vector<Slot> slots(slots_.empty() ? 64 : 2 * slots_.size());
+    const size_t mask = slots.size() - 1;
+    for (const Slot &slot : slots_) {
+      if (slot.name.data() == nullptr) {
+        continue;
+      }
+      size_t i = slot.hash & mask;
+      while (slots[i].name.data() != nullptr) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = slot;
+    }
+    slots_ = std::move(slots);
+  }
+
+  /// @brief Copy a name into the chunks (caller holds mu_)
+  /// @return A null-terminated view of the copy
+  std::string_view Store(std::string_view name) {
+    if (name.size() + 1 > left_) {
+      const size_t size =
+          name.size() + 1 > kChunkSize ? name.size() + 1 : kChunkSize;
+      chunks_.push_back(std::make_unique<char[]>(size));
+      next_ = chunks_.back().get();
+      left_ = size;
+    }
+    char *copy = next_;
+    std::memcpy(copy, name.data(), name.size());
+    copy[name.size()] = '\0';
+    next_ += name.size() + 1;
+    left_ -= name.size() + 1;
+    return std::string_view(copy, name.size());
+  }
+
+  mutable std::mutex mu_;                      ///< Guards the pool
+  std::vector<Slot> slots_;                    ///< The index, a power of two
+  size_t size_ = 0;                            ///< The number of names
+  std::vector<std::unique_ptr<char[]>> chunks_; ///< The names (stable)
+  char *next_ = nullptr;                       ///< The free space of the chunk
+  size_t left_ = 0;                            ///< The size of that space
+};
+
+/// @brief Intern a name in the process-wide pool
+/// @param name The name to intern
+/// @return A stable, null-terminated view of the pooled copy of name
+inline std::string_view InternName(std::string_view name) {
+  return DlNamePool::GetInstance().Intern(name);
+}
+
+} // namespace internal
+
+} // namespace dlutils
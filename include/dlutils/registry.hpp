@@ -0,0 +1,281 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dlutils/core.hpp"
+
+namespace dlutils {
+
+namespace internal {
+
+/// @brief Walks the process-wide list of live DlLibBase objects
+///
+/// Every DlLibBase links itself into a DlLibList on construction and out on
+/// destruction, so that GetLoadedLibraries() can list them.
+class DlLibDirectory {
+public:
+  DlLibDirectory() = delete;
+
+  /// @brief Call a function on every live library, in construction order
+  ///
+  /// A library being destroyed waits for the call to finish.
+  ///
+  /// @param fn The function, called with a const DlLibBase &
+  template <class Fn> static void ForEach(Fn &&fn) {
+    std::lock_guard<std::mutex> lock(DlLibBase::directory_.mu);
+    for (const DlLibBase *lib = DlLibBase::directory_.first; lib != nullptr;
+         lib = lib->nextLib_) {
+      fn(*lib);
+    }
+  }
+};
+
+} // namespace internal
+
+/// @brief List every library that is currently loaded
+///
+/// This covers all live DlLibBase objects (including those owned by a
+/// DlLibRegistry) that hold an open handle, in construction order.
+///
+/// @return The status of each loaded library
+inline std::vector<DlLibStatus> GetLoadedLibraries() {
+  std::vector<DlLibStatus> libs;
+  internal::DlLibDirectory::ForEach([&libs](const DlLibBase &lib) {
+    DlLibStatus status = lib.GetStatus();
+    if (!status.loadedLib.empty()) {
+      libs.push_back(std::move(status));
+    }
+  });
+  return libs;
+}
+
+/// @brief Unloads a set of libraries in dependency order
+///
+/// Libraries are added after the libraries they depend on, and UnloadAll()
+/// (or the destructor) closes them in the reverse order, so each library is
+/// closed before its dependencies. This makes teardown deterministic, instead
+/// of depending on the destruction order of the wrappers.
+///
+/// The group does not own the libraries: they must outlive the group or be
+/// unloaded before they are destroyed.
+class DlLibGroup {
+public:
+  /// @brief Default constructor
+  DlLibGroup() = default;
+
+  DlLibGroup(const DlLibGroup &) = delete;
+  DlLibGroup &operator=(const DlLibGroup &) = delete;
+
+  /// @brief Destructor, unloads all libraries
+  ~DlLibGroup() { UnloadAll(); }
+
+  /// @brief Add a library to the group
+  /// @param lib The library to add
+  /// @param deps The libraries lib depends on, which must already be added
+  /// @throws std::runtime_error if lib is already in the group or a
+  /// dependency is not
+  void Add(DlLibBase &lib,
+           std::initializer_list<const DlLibBase *> deps = {}) {
+    if (Contains(&lib)) {
+      throw std::runtime_error(internal::FormatString(
+          "Library ", lib.libName_, " is already in the unload group"));
+    }
+    for (const DlLibBase *dep : deps) {
+      if (!Contains(dep)) {
+        throw std::runtime_error(internal::FormatString(
+            "Library ", lib.libName_,
+            " depends on a library that is not in the unload group"));
+      }
+    }
+    libs_.push_back(&lib);
+  }
+
+  /// @brief Close all libraries, each one before its dependencies
+  ///
+  /// The group is empty afterwards.
+  ///
+  /// @return The number of libraries that were open and got closed
+  size_t UnloadAll() {
+    size_t closed = 0;
+    for (auto it = libs_.rbegin(); it != libs_.rend(); ++it) {
+      if ((*it)->SelfDlClose()) {
+        closed++;
+      }
+    }
+    libs_.clear();
+    return closed;
+  }
+
+  /// @brief Get the number of libraries in the group
+  /// @return The number of libraries
+  size_t Size() const { return libs_.size(); }
+
+private:
+  /// @brief Check whether a library is in the group
+  bool Contains(const DlLibBase *lib) const {
+    for (const DlLibBase *l : libs_) {
+      if (l == lib) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::vector<DlLibBase *> libs_; ///< The libraries, dependencies first
+};
+
+/// @brief The guard-free static storage of one library wrapper
+///
+/// A function-local static (the usual GetInstance()) checks a guard variable
+/// on every access, and constructs the wrapper on whichever call comes first.
+/// A slot is constant-initialized instead: it is raw storage plus a pointer
+/// that is nullptr until Init() constructs the wrapper, so Get() is a single
+/// load of a global. The wrapper is constructed and destroyed explicitly,
+/// usually for a whole DlLibRegistry at once.
+///
+/// A wrapper with a private constructor declares `friend class
+/// dlutils::DlLibSlot<Wrapper>;`.
+///
+/// @tparam Lib The library wrapper type (a DlLibBase subclass)
+template <class Lib> class DlLibSlot {
+public:
+  DlLibSlot() = delete;
+
+  /// @brief Get the wrapper; Init() must have been called
+  /// @return The wrapper
+  static Lib &Get() { return *instance_; }
+
+  /// @brief Check whether the wrapper has been constructed
+  /// @return true between Init() and Destroy()
+  static bool IsInitialized() { return instance_ != nullptr; }
+
+  /// @brief Construct the wrapper, unless it already exists
+  ///
+  /// Not thread-safe: call it from the start-up phase, before the threads
+  /// that use the wrapper are started.
+  ///
+  /// @param args The constructor arguments
+  /// @return The wrapper
+  /// @throws Any exception thrown by the wrapper's constructor
+  template <class... CtorArgs> static Lib &Init(CtorArgs &&...args) {
+    if (instance_ == nullptr) {
+      instance_ = ::new (static_cast<void *>(storage_))
+          Lib(std::forward<CtorArgs>(args)...);
+    }
+    return *instance_;
+  }
+
+  /// @brief Destroy the wrapper (which closes its library), if it exists
+  static void Destroy() {
+    if (instance_ != nullptr) {
+      Lib *lib = instance_;
+      instance_ = nullptr;
+      lib->~Lib();
+    }
+  }
+
+private:
+  alignas(Lib) static inline unsigned char storage_[sizeof(Lib)];
+  static inline Lib *instance_ = nullptr; ///< The wrapper, once constructed
+};
+
+/// @brief A compile-time list of library wrappers with a controlled lifetime
+///
+/// The wrappers are declared once, as a type, and live in DlLibSlot storage:
+///
+///   using Libraries = dlutils::DlLibRegistry<LibCrypto, LibZ>;
+///   Libraries::Init();                       // at start-up, in list order
+///   Libraries::Get<LibCrypto>().EVP_sha256(); // a plain global load
+///   Libraries::Shutdown();                   // in reverse order
+///
+/// Wrappers are default-constructed; list a library after the ones it
+/// depends on. GetLoadedLibraries() lists them, along with every other live
+/// DlLibBase.
+///
+/// @tparam Libs The library wrapper types
+template <class... Libs> class DlLibRegistry {
+public:
+  static_assert(sizeof...(Libs) > 0, "The registry must not be empty");
+  static_assert((std::is_base_of_v<DlLibBase, Libs> && ...),
+                "Registered libraries must derive from DlLibBase");
+
+  DlLibRegistry() = delete;
+
+  /// @brief The number of registered libraries
+  static constexpr size_t kSize = sizeof...(Libs);
+
+  /// @brief Construct every wrapper, in list order
+  ///
+  /// If a constructor throws, the wrappers constructed so far are destroyed
+  /// again before the exception propagates.
+  ///
+  /// @throws Any exception thrown by a wrapper's constructor
+  static void Init() {
+    size_t done = 0;
+    try {
+      ((DlLibSlot<Libs>::Init(), ++done), ...);
+    } catch (...) {
+      DestroyFirst(done);
+      throw;
+    }
+  }
+
+  /// @brief Destroy every wrapper, in reverse list order
+  static void Shutdown() { DestroyFirst(kSize); }
+
+  /// @brief Get a registered wrapper; Init() must have been called
+  /// @tparam Lib The wrapper type
+  /// @return The wrapper
+  template <class Lib> static Lib &Get() {
+    static_assert((std::is_same_v<Lib, Libs> || ...),
+                  "The library is not in this registry");
+    return DlLibSlot<Lib>::Get();
+  }
+
+  /// @brief Check whether every wrapper has been constructed
+  /// @return true if Init() succeeded and Shutdown() was not called
+  static bool IsInitialized() {
+    return (DlLibSlot<Libs>::IsInitialized() && ...);
+  }
+
+private:
+  /// @brief Destroy the first n wrappers, in reverse list order
+  static void DestroyFirst(size_t n) {
+    using Destroyer = void (*)();
+    constexpr Destroyer kDestroy[] = {&DlLibSlot<Libs>::Destroy...};
+    while (n > 0) {
+      kDestroy[--n]();
+    }
+  }
+};
+
+} // namespace dlutils
@@ -0,0 +1,325 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dlutils/core.hpp"
+
+namespace dlutils {
+
+/// @brief A pool of library-allocated resources with per-thread free lists
+///
+/// Many C libraries hand out resources through a pair of functions, such as
+/// EVP_MD_CTX_new and EVP_MD_CTX_free. Creating one per use costs two calls
+/// into the library and a heap allocation inside it. This pool keeps the
+/// released resources on a free list private to the releasing thread, so
+/// that the next Acquire() on that thread reuses one without any locking.
+///
+/// The pool refers to the DlFun members of a DlLibBase subclass, so it must
+/// not outlive them. Resources are freed when a thread exits (for that
+/// thread's free list, which the pool then forgets) and when the pool is
+/// destroyed, so threads that come and go do not grow the pool, and pools
+/// that come and go do not grow the threads (each thread drops the free
+/// lists of destroyed pools the next time it starts one). A library
+/// must not be reloaded with a different build while the pool holds
+/// resources created by the old one; destroy or Clear() the pool first.
+///
+/// @tparam T The (usually opaque) resource type
+template <class T> class DlResourcePool {
+public:
+  /// @brief A leased resource, released back to the pool when destroyed
+  class Handle {
+  public:
+    /// @brief Default constructor, holds no resource
+    Handle() = default;
+
+    /// @brief Move constructor
+    Handle(Handle &&other) noexcept
+        : pool_(std::exchange(other.pool_, nullptr)),
+          res_(std::exchange(other.res_, nullptr)) {}
+
+    /// @brief Move assignment, releases the held resource first
+    Handle &operator=(Handle &&other) noexcept {
+      if (this != &other) {
+        Reset();
+        pool_ = std::exchange(other.pool_, nullptr);
+        res_ = std::exchange(other.res_, nullptr);
+      }
+      return *this;
+    }
+
+    Handle(const Handle &) = delete;
+    Handle &operator=(const Handle &) = delete;
+
+    /// @brief Destructor, releases the resource
+    ~Handle() { Reset(); }
+
+    /// @brief Get the resource
+    /// @return The resource (nullptr if none is held)
+    T *Get() const { return res_; }
+
+    /// @brief Release the resource to the pool now
+    void Reset() {
+      if (res_ != nullptr) {
+        pool_->Release(std::exchange(res_, nullptr));
+      }
+    }
+
+  private:
+    friend class DlResourcePool;
+
+    Handle(DlResourcePool *pool, T *res) : pool_(pool), res_(res) {}
+
+    DlResourcePool *pool_ = nullptr; ///< The pool the resource returns to
+    T *res_ = nullptr;               ///< The leased resource
+  };
+
+  /// @brief Constructor
+  /// @param create Creates a resource (returns nullptr on failure)
+  /// @param destroy Frees a resource
+  /// @param perThreadLimit The maximum number of free resources kept per
+  /// thread; further releases free the resource
+  DlResourcePool(DlFun<T *> &create, DlFun<void, T *> &destroy,
+                 size_t perThreadLimit = 8)
+      : create_(create), destroy_(destroy), limit_(perThreadLimit),
+        id_(NextId()), registry_(std::make_shared<Registry>()) {}
+
+  DlResourcePool(const DlResourcePool &) = delete;
+  DlResourcePool &operator=(const DlResourcePool &) = delete;
+
+  /// @brief Destructor, frees the free resources of every thread
+  ///
+  /// Resources still leased through a Handle must be released before. The
+  /// threads that used the pool drop their (now empty) free lists the next
+  /// time they start one for another pool, or when they exit.
+  ~DlResourcePool() {
+    Clear();
+    registry_->dead.store(true, std::memory_order_release);
+  }
+
+  /// @brief Set a function run on each resource when it is released
+  ///
+  /// Typically the library's reset function, e.g. EVP_MD_CTX_reset, so that
+  /// a reused resource starts from a clean state.
+  ///
+  /// @param reset The reset function
+  void SetReset(std::function<void(T *)> reset) { reset_ = std::move(reset); }
+
+  /// @brief Lease a resource, reusing one released on this thread if any
+  /// @return The leased resource
+  /// @throws std::runtime_error if a new resource cannot be created
+  Handle Acquire() {
+    std::vector<T *> &free = LocalShard().free;
+    if (!free.empty()) {
+      T *res = free.back();
+      free.pop_back();
+      return Handle(this, res);
+    }
+    T *res = create_();
+    if (res == nullptr) {
+      throw std::runtime_error(internal::FormatString(
+          "Failed to create a pooled resource with ", create_.GetName()));
+    }
+    return Handle(this, res);
+  }
+
+  /// @brief Return a resource to the free list of this thread
+  ///
+  /// The resource is reset first (see SetReset()). It is freed instead if the
+  /// free list is full.
+  ///
+  /// @param res The resource, as returned by Acquire()
+  void Release(T *res) {
+    if (reset_) {
+      reset_(res);
+    }
+    std::vector<T *> &free = LocalShard().free;
+    if (free.size() < limit_) {
+      free.push_back(res);
+    } else {
+      destroy_(res);
+    }
+  }
+
+  /// @brief Get the number of free resources of this thread
+  /// @return The size of the free list of the calling thread
+  size_t LocalFreeCount() { return LocalShard().free.size(); }
+
+  /// @brief Get the number of threads that have a free list in this pool
+  ///
+  /// A thread's free list is dropped when the thread exits, so this counts
+  /// the live threads that used the pool since the last Clear().
+  ///
+  /// @return The number of registered free lists
+  size_t ThreadCount() const {
+    std::lock_guard<std::mutex> lock(registry_->mu);
+    return registry_->shards.size();
+  }
+
+  /// @brief Get the number of free lists the calling thread keeps
+  ///
+  /// Counts the free lists of this thread in every pool of T, including
+  /// those of destroyed pools that the thread has not dropped yet.
+  ///
+  /// @return The number of free lists of the calling thread
+  static size_t LocalShardCount() { return Local().shards.size(); }
+
+  /// @brief Free the free resources of every thread
+  ///
+  /// Must not run concurrently with Acquire() or Release() on this pool.
+  void Clear() {
+    std::lock_guard<std::mutex> lock(registry_->mu);
+    for (Shard *shard : registry_->shards) {
+      for (T *res : shard->free) {
+        destroy_(res);
+      }
+      shard->free.clear();
+      shard->pool = nullptr; // Detach, the thread re-registers on next use
+    }
+    registry_->shards.clear();
+  }
+
+private:
+  struct Shard;
+
+  /// @brief The free lists of all threads
+  ///
+  /// Shared by the pool and its shards, so that an exiting thread can still
+  /// lock it while the pool is being destroyed. The mutex guards the list
+  /// and the pool and free members of every registered shard on teardown.
+  struct Registry {
+    std::mutex mu;                 ///< Guards shards and their teardown
+    std::vector<Shard *> shards;   ///< The registered free lists
+    std::atomic<bool> dead{false}; ///< Set once the pool is destroyed
+  };
+
+  /// @brief The free list of one thread
+  ///
+  /// Owned by the thread-local map of the thread. The owning thread uses the
+  /// free list without locking; Registry::mu is only taken to register it,
+  /// and when the thread exits or the pool is cleared.
+  struct Shard {
+    std::shared_ptr<Registry> registry; ///< Where the shard is registered
+    DlResourcePool *pool = nullptr;     ///< The pool, nullptr once detached
+    std::vector<T *> free;              ///< The free resources of the thread
+  };
+
+  /// @brief The shards of the calling thread, freed when the thread exits
+  struct LocalShards {
+    LocalShards() = default;
+    LocalShards(const LocalShards &) = delete;
+    LocalShards &operator=(const LocalShards &) = delete;
+
+    /// @brief Free the resources the exiting thread kept, and unregister
+    ~LocalShards() {
+      for (auto &entry : shards) {
+        Shard &shard = *entry.second;
+        std::lock_guard<std::mutex> lock(shard.registry->mu);
+        if (shard.pool != nullptr) {
+          for (T *res : shard.free) {
+            shard.pool->destroy_(res);
+          }
+          shard.free.clear();
+          auto &list = shard.registry->shards;
+          list.erase(std::find(list.begin(), list.end(), &shard));
+        }
+      }
+    }
+
+    /// @brief Drop the shards of destroyed pools
+    void Sweep() {
+      for (auto it = shards.begin(); it != shards.end();) {
+        if (it->second->registry->dead.load(std::memory_order_acquire)) {
+          if (it->second.get() == last) {
+            last = nullptr;
+          }
+          it = shards.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+
+    /// @brief The shard of each pool, by pool id
+    std::unordered_map<uint64_t, std::unique_ptr<Shard>> shards;
+    uint64_t lastId = 0;   ///< The pool id of last
+    Shard *last = nullptr; ///< The shard used last, found without hashing
+  };
+
+  /// @brief Get the shards of the calling thread
+  static LocalShards &Local() {
+    thread_local LocalShards local;
+    return local;
+  }
+
+  /// @brief Get the shard of the calling thread, creating it on first use
+  Shard &LocalShard() {
+    LocalShards &local = Local();
+    Shard *shard = local.last;
+    if (DLUTILS_LIKELY(shard != nullptr && local.lastId == id_ &&
+                       shard->pool != nullptr)) {
+      return *shard;
+    }
+    auto it = local.shards.find(id_);
+    if (it == local.shards.end()) {
+      local.Sweep(); // Pool churn is paid for here, not on the fast path
+      it = local.shards.emplace(id_, std::make_unique<Shard>()).first;
+      it->second->registry = registry_;
+    }
+    shard = it->second.get();
+    if (shard->pool == nullptr) {
+      std::lock_guard<std::mutex> lock(registry_->mu);
+      shard->pool = this;
+      registry_->shards.push_back(shard);
+    }
+    local.lastId = id_;
+    local.last = shard;
+    return *shard;
+  }
+
+  /// @brief Get a process-wide unique pool id (never reused)
+  static uint64_t NextId() {
+    static std::atomic<uint64_t> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  DlFun<T *> &create_;                 ///< Creates a resource
+  DlFun<void, T *> &destroy_;          ///< Frees a resource
+  std::function<void(T *)> reset_;     ///< Resets a released resource
+  const size_t limit_;                 ///< Free resources kept per thread
+  const uint64_t id_;                  ///< The key of the thread-local shards
+  std::shared_ptr<Registry> registry_; ///< The free lists of all threads
+};
+
+} // namespace dlutils
@@ -0,0 +1,267 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <dlfcn.h>
+#include <pthread.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "dlutils/name_pool.hpp"
+
+namespace dlutils {
+
+namespace internal {
+
+/// @brief A reader-writer lock
+///
+/// The pthread lock behind std::shared_mutex, without <shared_mutex>, which
+/// costs more to parse than the whole cache. It meets the Lockable
+/// requirements, so std::lock_guard takes it exclusively; ReadLock takes it
+/// shared.
+class DlRwLock {
+public:
+  DlRwLock() = default;
+  DlRwLock(const DlRwLock &) = delete;
+  DlRwLock &operator=(const DlRwLock &) = delete;
+
+  /// @brief Destructor
+  ~DlRwLock() { pthread_rwlock_destroy(&lock_); }
+
+  /// @brief Take the lock exclusively
+  void lock() { pthread_rwlock_wrlock(&lock_); }
+
+  /// @brief Release the lock
+  void unlock() { pthread_rwlock_unlock(&lock_); }
+
+  /// @brief Holds the lock shared for its lifetime
+  class ReadLock {
+  public:
+    /// @brief Take the lock shared
+    explicit ReadLock(DlRwLock &lock) : lock_(lock) {
+      pthread_rwlock_rdlock(&lock_.lock_);
+    }
+
+    /// @brief Release the lock
+    ~ReadLock() { pthread_rwlock_unlock(&lock_.lock_); }
+
+    ReadLock(const ReadLock &) = delete;
+    ReadLock &operator=(const ReadLock &) = delete;
+
+  private:
+    DlRwLock &lock_; ///< The held lock
+  };
+
+private:
+  pthread_rwlock_t lock_ = PTHREAD_RWLOCK_INITIALIZER; ///< The lock
+};
+
+/// @brief Process-wide cache of resolved symbols
+///
+/// Every DlLibBase resolves its symbols through this cache, keyed by the
+/// library handle and the symbol name. dlopen returns the same handle for a
+/// library that is already loaded, so wrapper instances for the same library
+/// share their lookups: only the first one pays for dlsym.
+///
+/// The cache is read-mostly. It is split into shards, each guarded by a
+/// reader-writer lock, so concurrent lookups only take a shared lock on one
+/// shard. Each shard is an open-addressing table, at most half full.
+/// Failed lookups are cached too, as negative entries: the symbols a handle
+/// can reach are fixed once it is open, so a missing symbol is only searched
+/// for once per handle, even across reloads that reopen the same handle. The
+/// entries of a handle must be invalidated before the handle is closed (see
+/// DlLibBase::SelfDlClose()), since dlopen may reuse a closed handle address
+/// for another library.
+class DlSymbolCache {
+public:
+  /// @brief The number of shards
+  static constexpr size_t kShards = 16;
+
+  /// @brief Get the process-wide cache
+  /// @return The cache instance
+  static DlSymbolCache &GetInstance() {
+    static DlSymbolCache instance;
+    return instance;
+  }
+
+  DlSymbolCache(const DlSymbolCache &) = delete;
+  DlSymbolCache &operator=(const DlSymbolCache &) = delete;
+
+  /// @brief Resolve a symbol, calling dlsym only on a cache miss
+  /// @param handle The library handle
+  /// @param name The symbol name (must be null-terminated)
+  /// @return The symbol address, nullptr if it is missing
+  void *Resolve(void *handle, std::string_view name) {
+    void *ptr = nullptr;
+    if (Lookup(handle, name, &ptr)) {
+      return ptr;
+    }
+    ptr = dlsym(handle, name.data());
+    Insert(handle, name, ptr);
+    return ptr;
+  }
+
+  /// @brief Look up a symbol without calling dlsym
+  /// @param handle The library handle
+  /// @param name The symbol name
+  /// @param out The cached symbol address, if found (nullptr for a symbol
+  /// known to be missing)
+  /// @return true if the symbol was in the cache
+  bool Lookup(void *handle, std::string_view name, void **out) const {
+    const size_t hash = Hash(handle, name);
+    const Shard &shard = shards_[hash % kShards];
+    DlRwLock::ReadLock lock(shard.mu);
+    const Entry *entry = shard.Find(hash, handle, name);
+    if (entry == nullptr || entry->name.data() == nullptr) {
+      return false;
+    }
+    *out = entry->ptr;
+    return true;
+  }
+
+  /// @brief Add a resolved symbol to the cache
+  /// @param handle The library handle
+  /// @param name The symbol name
+  /// @param ptr The symbol address, nullptr for a missing symbol
+  void Insert(void *handle, std::string_view name, void *ptr) {
+    const size_t hash = Hash(handle, name);
+    Shard &shard = shards_[hash % kShards];
+    std::lock_guard<DlRwLock> lock(shard.mu);
+    if (2 * (shard.size + 1) > shard.entries.size()) {
+      shard.Rebuild(shard.entries.empty() ? 16 : 2 * shard.entries.size(),
+                    nullptr);
+    }
+    Entry *entry = const_cast<Entry *>(shard.Find(hash, handle, name));
+    if (entry->name.data() == nullptr) {
+      *entry = Entry{hash, handle, InternName(name), ptr};
+      shard.size++;
+    } else {
+      entry->ptr = ptr;
+    }
+  }
+
+  /// @brief Drop all cached symbols of a library handle
+  /// @param handle The library handle
+  void Invalidate(void *handle) {
+    for (auto &shard : shards_) {
+      std::lock_guard<DlRwLock> lock(shard.mu);
+      if (shard.Holds(handle)) {
+        shard.Rebuild(shard.entries.size(), handle);
+      }
+    }
+  }
+
+  /// @brief Get the number of cached symbols
+  /// @return The number of cached symbols, including the missing ones
+  size_t Size() const {
+    size_t size = 0;
+    for (const auto &shard : shards_) {
+      DlRwLock::ReadLock lock(shard.mu);
+      size += shard.size;
+    }
+    return size;
+  }
+
+private:
+  DlSymbolCache() = default;
+
+  /// @brief A cached symbol
+  struct Entry {
+    size_t hash = 0;        ///< The hash of (handle, name)
+    void *handle = nullptr; ///< The library handle
+    std::string_view name;  ///< The interned symbol name, null if empty
+    void *ptr = nullptr;    ///< The symbol address, nullptr if missing
+  };
+
+  /// @brief One shard of the cache, keyed by the hash of (handle, name)
+  struct alignas(64) Shard {
+    mutable DlRwLock mu;        ///< Guards the entries
+    std::vector<Entry> entries; ///< A power of two of slots, or none
+    size_t size = 0;            ///< The number of used slots
+
+    /// @brief Find the slot of a key (caller holds mu)
+    /// @return The entry of the key, or the empty slot where it belongs;
+    /// nullptr if there are no slots
+    const Entry *Find(size_t hash, void *handle, std::string_view name) const {
+      if (entries.empty()) {
+        return nullptr;
+      }
+      // The low bits picked the shard, so probe with the others
+      const size_t mask = entries.size() - 1;
+      for (size_t i = (hash / kShards) & mask;; i = (i + 1) & mask) {
+        const Entry &entry = entries[i];
+        if (entry.name.data() == nullptr ||
+            (entry.hash == hash && entry.handle == handle &&
+             entry.name == name)) {
+          return &entry;
+        }
+      }
+    }
+
+    /// @brief Check whether a handle has entries (caller holds mu)
+    bool Holds(void *handle) const {
+      for (const Entry &entry : entries) {
+        if (entry.name.data() != nullptr && entry.handle == handle) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /// @brief Rehash into a number of slots, dropping the entries of a
+    /// handle (caller holds mu exclusively)
+    /// @param slots The new number of slots, a power of two
+    /// @param drop The handle to drop, nullptr to keep every entry
+    void Rebuild(size_t slots, void *drop) {
+      std::vector<Entry> old = std::exchange(entries, std::vector<Entry>());
+      entries.resize(slots);
+      size = 0;
+      for (const Entry &entry : old) {
+        if (entry.name.data() != nullptr && entry.handle != drop) {
+          *const_cast<Entry *>(Find(entry.hash, entry.handle, entry.name)) =
+              entry;
+          size++;
+        }
+      }
+    }
+  };
+
+  /// @brief Hash a (handle, name) key
+  static size_t Hash(void *handle, std::string_view name) {
+    size_t h = std::hash<std::string_view>()(name);
+    size_t k = reinterpret_cast<uintptr_t>(handle);
+    return h ^ (k + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+  }
+
+  std::array<Shard, kShards> shards_; ///< The cache shards
+};
+
+} // namespace internal
+
+} // namespace dlutils
@@ -0,0 +1,542 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "dlutils/core.hpp"
+#include "dlutils/cpu_features.hpp"
+
+/// @brief Whether symbol manifests are supported
+///
+/// Manifests need dlinfo, dladdr1 and dl_iterate_phdr to identify a library
+/// and its load base, which are GNU extensions. Without them, manifests never
+/// validate and every symbol is resolved with dlsym.
+#ifndef DLUTILS_HAS_SYMBOL_MANIFEST
+#if defined(__GLIBC__) && defined(_GNU_SOURCE)
+#define DLUTILS_HAS_SYMBOL_MANIFEST 1
+#else
+#define DLUTILS_HAS_SYMBOL_MANIFEST 0
+#endif
+#endif
+
+#if DLUTILS_HAS_SYMBOL_MANIFEST
+#include <elf.h>
+#include <link.h>
+#endif
+
+namespace dlutils {
+
+namespace internal {
+
+/// @brief What a manifest is valid for: one build of a library on one host
+struct DlLibraryId {
+  uintptr_t base = 0;           ///< The load bias symbol offsets are from
+  const void *linkMap = nullptr; ///< The link map of the library
+  uint64_t dev = 0;             ///< The device of the library file
+  uint64_t ino = 0;             ///< The inode of the library file
+  uint64_t size = 0;            ///< The size of the library file
+  int64_t mtimeSec = 0;         ///< The modification time of the file
+  int64_t mtimeNsec = 0;        ///< The nanoseconds of the modification time
+  uint64_t cpuFeatures = 0;     ///< The host features (they select IFUNCs)
+  uint32_t buildIdSize = 0;     ///< The size of the GNU build-id, 0 if none
+  uint8_t buildId[32] = {};     ///< The GNU build-id (truncated to 32 bytes)
+  /// @brief The executable PT_LOAD ranges [begin, end), as offsets from base
+  std::vector<std::pair<uint64_t, uint64_t>> text;
+
+  /// @brief Check whether an offset from base lies in executable code
+  /// @param offset The offset of a symbol from the load base
+  /// @return true if an executable segment of the library contains it
+  bool IsText(uint64_t offset) const {
+    return std::any_of(text.begin(), text.end(), [offset](const auto &r) {
+      return offset >= r.first && offset < r.second;
+    });
+  }
+};
+
+#if DLUTILS_HAS_SYMBOL_MANIFEST
+/// @brief Find the executable segments and GNU build-id of a loaded object
+/// @param id The library to look for (base and linkMap set), updated
+inline void InspectSegments(DlLibraryId *id) {
+  auto callback = [](struct dl_phdr_info *info, size_t, void *data) -> int {
+    auto *id = static_cast<DlLibraryId *>(data);
+    if (info->dlpi_addr != id->base) {
+      return 0;
+    }
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+      const ElfW(Phdr) &phdr = info->dlpi_phdr[i];
+      if (phdr.p_type == PT_LOAD && (phdr.p_flags & PF_X) != 0) {
+        id->text.emplace_back(phdr.p_vaddr, phdr.p_vaddr + phdr.p_memsz);
+        continue;
+      }
+      if (phdr.p_type != PT_NOTE || id->buildIdSize != 0) {
+        continue;
+      }
+      const size_t align = phdr.p_align == 8 ? 8 : 4;
+      auto pad = [align](size_t n) { return (n + align - 1) & ~(align - 1); };
+      const char *p = reinterpret_cast<const char *>(info->dlpi_addr +
+                                                     phdr.p_vaddr);
+      const char *end = p + phdr.p_memsz;
+      while (p + sizeof(ElfW(Nhdr)) <= end) {
+        const auto *note = reinterpret_cast<const ElfW(Nhdr) *>(p);
+        const char *name = p + sizeof(ElfW(Nhdr));
+        const char *desc = name + pad(note->n_namesz);
+        if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 &&
+            std::memcmp(name, "GNU", 4) == 0) {
+          id->buildIdSize = std::min<uint32_t>(note->n_descsz, 32);
+          std::memcpy(id->buildId, desc, id->buildIdSize);
+          break;
+        }
+        p = desc + pad(note->n_descsz);
+      }
+    }
+    return 1;
+  };
+  dl_iterate_phdr(callback, id);
+}
+#endif
+
+/// @brief Identify the library behind a handle
+/// @param handle The library handle
+/// @param id The identity of the library
+/// @return true if the library could be identified (it has a file name)
+inline bool IdentifyLibrary(void *handle, DlLibraryId *id) {
+#if DLUTILS_HAS_SYMBOL_MANIFEST
+  struct link_map *lm = nullptr;
+  if (handle == nullptr || dlinfo(handle, RTLD_DI_LINKMAP, &lm) != 0 ||
+      lm == nullptr || lm->l_name == nullptr || lm->l_name[0] == '\0') {
+    return false;
+  }
+  struct stat st;
+  if (stat(lm->l_name, &st) != 0) {
+    return false;
+  }
+  *id = DlLibraryId();
+  id->base = static_cast<uintptr_t>(lm->l_addr);
+  id->linkMap = lm;
+  id->dev = static_cast<uint64_t>(st.st_dev);
+  id->ino = static_cast<uint64_t>(st.st_ino);
+  id->size = static_cast<uint64_t>(st.st_size);
+  id->mtimeSec = static_cast<int64_t>(st.st_mtim.tv_sec);
+  id->mtimeNsec = static_cast<int64_t>(st.st_mtim.tv_nsec);
+  id->cpuFeatures = static_cast<uint64_t>(GetCpuFeatures());
+  InspectSegments(id);
+  return true;
+#else
+  (void)handle;
+  (void)id;
+  return false;
+#endif
+}
+
+} // namespace internal
+
+/// @brief An on-disk cache of symbol offsets for one library build
+///
+/// Resolving hundreds of symbols with dlsym at every start costs a hash
+/// lookup in each loaded object per symbol. A manifest stores the offset of
+/// each symbol from the load base of the library. It is memory-mapped and
+/// searched by name (the entries are sorted), so a hit costs a binary search
+/// and an addition.
+///
+/// A manifest is only used for the exact library file it was written for: it
+/// is keyed by the device, inode, size and modification time of the file, by
+/// its GNU build-id if it has one, and by the host CPU features (which select
+/// the IFUNC implementations dlsym returns). If any of them differ, or the
+/// file is malformed, the manifest is ignored and symbols are resolved with
+/// dlsym. The same happens if any entry points outside the executable
+/// segments of the library, so a stale or tampered file cannot redirect a
+/// call into data. Functions that dlsym resolves are recorded, and Save()
+/// writes them out for the next start.
+///
+/// File layout (native byte order): a Header, then Header::count Entry
+/// records sorted by name, then the null-terminated names.
+class DlSymbolManifest : public internal::DlSymbolSource {
+public:
+  /// @brief The manifest file header
+  struct Header {
+    char magic[8];         ///< kMagic
+    uint32_t version;      ///< kVersion
+    uint32_t count;        ///< The number of entries
+    uint64_t dev;          ///< DlLibraryId::dev
+    uint64_t ino;          ///< DlLibraryId::ino
+    uint64_t size;         ///< DlLibraryId::size
+    int64_t mtimeSec;      ///< DlLibraryId::mtimeSec
+    int64_t mtimeNsec;     ///< DlLibraryId::mtimeNsec
+    uint64_t cpuFeatures;  ///< DlLibraryId::cpuFeatures
+    uint32_t buildIdSize;  ///< DlLibraryId::buildIdSize
+    uint32_t stringsSize;  ///< The size of the name table
+    uint8_t buildId[32];   ///< DlLibraryId::buildId
+  };
+
+  /// @brief One symbol of the manifest
+  struct Entry {
+    uint64_t offset;     ///< The address of the symbol minus the load base
+    uint32_t nameOffset; ///< The offset of the name in the name table
+    uint32_t nameSize;   ///< The length of the name (without the null)
+  };
+
+  static_assert(sizeof(Header) == 104, "Unexpected manifest header layout");
+  static_assert(sizeof(Entry) == 16, "Unexpected manifest entry layout");
+
+  /// @brief The file magic
+  static constexpr char kMagic[8] = {'D', 'L', 'U', 'S', 'Y', 'M', 'S', '\0'};
+
+  /// @brief The file format version
+  static constexpr uint32_t kVersion = 1;
+
+  /// @brief Default constructor, an empty manifest bound to no library
+  DlSymbolManifest() = default;
+
+  DlSymbolManifest(const DlSymbolManifest &) = delete;
+  DlSymbolManifest &operator=(const DlSymbolManifest &) = delete;
+
+  /// @brief Destructor, unmaps the file
+  ~DlSymbolManifest() override { Unmap(); }
+
+  /// @brief Bind to a loaded library and map its manifest
+  ///
+  /// The manifest is bound to the library even if the file is missing or
+  /// does not validate, so that the symbols resolved afterwards are recorded
+  /// and Save() can write a fresh one.
+  ///
+  /// @param path The manifest file
+  /// @param handle The library handle
+  /// @return true if the file was mapped and is valid for the library
+  bool Open(std::string path, void *handle) {
+    Unmap();
+    std::lock_guard<std::mutex> lock(mu_);
+    pending_.clear();
+    path_ = std::move(path);
+    handle_ = nullptr;
+    if (!internal::IdentifyLibrary(handle, &id_)) {
+      return false;
+    }
+    handle_ = handle;
+    return Map();
+  }
+
+  /// @brief Check whether the manifest is bound to a library handle
+  /// @param handle The library handle
+  /// @return true if Open() identified the library of this handle
+  bool IsBound(void *handle) const {
+    return handle != nullptr && handle == handle_;
+  }
+
+  /// @brief Check whether a valid manifest file is mapped
+  /// @return true if Open() mapped a file valid for the library
+  bool IsValid() const { return entries_ != nullptr; }
+
+  /// @brief Get the number of symbols in the mapped file
+  /// @return The number of entries, 0 if no valid file is mapped
+  size_t Size() const { return count_; }
+
+  /// @brief Get the manifest file path
+  /// @return The path given to Open()
+  const std::string &GetPath() const { return path_; }
+
+  /// @brief Look up a symbol in the mapped file
+  /// @param name The symbol name
+  /// @return The symbol address, nullptr if the symbol is not in the file
+  void *Find(std::string_view name) const override {
+    const Entry *first = entries_;
+    const Entry *last = entries_ + count_;
+    const Entry *it = std::lower_bound(
+        first, last, name, [this](const Entry &e, std::string_view n) {
+          return NameOf(e) < n;
+        });
+    if (it == last || NameOf(*it) != name) {
+      return nullptr;
+    }
+    return reinterpret_cast<void *>(id_.base + it->offset);
+  }
+
+  /// @brief Record a symbol resolved with dlsym, to be written by Save()
+  ///
+  /// Symbols that dlsym found in another library (a dependency) are not
+  /// recorded, since their offset from this library's base is not stable,
+  /// and neither are symbols outside its executable segments (variables),
+  /// which Validate() would reject.
+  ///
+  /// @param name The symbol name
+  /// @param ptr The symbol address
+  void Record(std::string_view name, void *ptr) override {
+#if DLUTILS_HAS_SYMBOL_MANIFEST
+    Dl_info info;
+    struct link_map *lm = nullptr;
+    if (handle_ == nullptr ||
+        dladdr1(ptr, &info, reinterpret_cast<void **>(&lm),
+                RTLD_DL_LINKMAP) == 0 ||
+        lm != id_.linkMap) {
+      return;
+    }
+    uint64_t offset = reinterpret_cast<uintptr_t>(ptr) - id_.base;
+    if (!id_.IsText(offset)) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    pending_.emplace_back(std::string(name), offset);
+#else
+    (void)name;
+    (void)ptr;
+#endif
+  }
+
+  /// @brief Check whether symbols were recorded since Open()
+  /// @return true if Save() would add symbols to the file
+  bool IsDirty() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return !pending_.empty();
+  }
+
+  /// @brief Write the mapped and the recorded symbols to the manifest file
+  ///
+  /// The file is written next to the target and renamed over it, so that a
+  /// concurrent Open() sees either the old or the new file. The mapping is
+  /// not refreshed; the new file is used from the next Open().
+  ///
+  /// @return true if the file was written
+  bool Save() const {
+    if (handle_ == nullptr) {
+      return false;
+    }
+    std::vector<std::pair<std::string, uint64_t>> symbols;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      symbols = pending_;
+    }
+    for (size_t i = 0; i < count_; i++) {
+      symbols.emplace_back(std::string(NameOf(entries_[i])),
+                           entries_[i].offset);
+    }
+    std::stable_sort(
+        symbols.begin(), symbols.end(),
+        [](const auto &a, const auto &b) { return a.first < b.first; });
+    symbols.erase(std::unique(symbols.begin(), symbols.end(),
+                              [](const auto &a, const auto &b) {
+                                return a.first == b.first;
+                              }),
+                  symbols.end());
+
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.count = static_cast<uint32_t>(symbols.size());
+    header.dev = id_.dev;
+    header.ino = id_.ino;
+    header.size = id_.size;
+    header.mtimeSec = id_.mtimeSec;
+    header.mtimeNsec = id_.mtimeNsec;
+    header.cpuFeatures = id_.cpuFeatures;
+    header.buildIdSize = id_.buildIdSize;
+    std::memcpy(header.buildId, id_.buildId, sizeof(header.buildId));
+
+    std::vector<Entry> entries;
+    std::string strings;
+    entries.reserve(symbols.size());
+    for (const auto &symbol : symbols) {
+      entries.push_back(Entry{symbol.second,
+                              static_cast<uint32_t>(strings.size()),
+                              static_cast<uint32_t>(symbol.first.size())});
+      strings.append(symbol.first).append(1, '\0');
+    }
+    header.stringsSize = static_cast<uint32_t>(strings.size());
+
+    const std::string tmp = path_ + ".tmp." + std::to_string(getpid());
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      return false;
+    }
+    bool ok = WriteAll(fd, &header, sizeof(header)) &&
+              WriteAll(fd, entries.data(), entries.size() * sizeof(Entry)) &&
+              WriteAll(fd, strings.data(), strings.size());
+    ok = (close(fd) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path_.c_str()) != 0) {
+      unlink(tmp.c_str());
+      return false;
+    }
+    return true;
+  }
+
+private:
+  /// @brief Map the file and validate it against id_ (caller holds mu_)
+  bool Map() {
+    int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= 0 &&
+        static_cast<size_t>(st.st_size) >= sizeof(Header)) {
+      map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                 MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) {
+      return false;
+    }
+    map_ = map;
+    mapSize_ = static_cast<size_t>(st.st_size);
+    if (!Validate()) {
+      Unmap();
+      return false;
+    }
+    return true;
+  }
+
+  /// @brief Check the mapped file, and set up entries_ if it is valid
+  bool Validate() {
+    const auto *header = static_cast<const Header *>(map_);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+        header->version != kVersion || header->dev != id_.dev ||
+        header->ino != id_.ino || header->size != id_.size ||
+        header->mtimeSec != id_.mtimeSec ||
+        header->mtimeNsec != id_.mtimeNsec ||
+        header->cpuFeatures != id_.cpuFeatures ||
+        header->buildIdSize != id_.buildIdSize ||
+        std::memcmp(header->buildId, id_.buildId, sizeof(id_.buildId)) != 0) {
+      return false;
+    }
+    const uint64_t tableSize =
+        sizeof(Header) + uint64_t{header->count} * sizeof(Entry);
+    if (tableSize + header->stringsSize != mapSize_) {
+      return false;
+    }
+    const auto *entries = reinterpret_cast<const Entry *>(header + 1);
+    const char *strings = reinterpret_cast<const char *>(entries) +
+                          uint64_t{header->count} * sizeof(Entry);
+    for (uint32_t i = 0; i < header->count; i++) {
+      const Entry &e = entries[i];
+      if (uint64_t{e.nameOffset} + e.nameSize >= header->stringsSize ||
+          strings[e.nameOffset + e.nameSize] != '\0' ||
+          !id_.IsText(e.offset)) {
+        return false;
+      }
+      // The lookups binary search, so the names must be strictly sorted
+      if (i > 0 && std::string_view(strings + entries[i - 1].nameOffset,
+                                    entries[i - 1].nameSize) >=
+                       std::string_view(strings + e.nameOffset, e.nameSize)) {
+        return false;
+      }
+    }
+    entries_ = entries;
+    strings_ = strings;
+    count_ = header->count;
+    return true;
+  }
+
+  /// @brief Unmap the file
+  void Unmap() {
+    if (map_ != nullptr) {
+      munmap(map_, mapSize_);
+    }
+    map_ = nullptr;
+    mapSize_ = 0;
+    entries_ = nullptr;
+    strings_ = nullptr;
+    count_ = 0;
+  }
+
+  /// @brief Get the name of a mapped entry
+  std::string_view NameOf(const Entry &e) const {
+    return std::string_view(strings_ + e.nameOffset, e.nameSize);
+  }
+
+  /// @brief Write a whole buffer to a file descriptor
+  static bool WriteAll(int fd, const void *data, size_t size) {
+    const char *p = static_cast<const char *>(data);
+    while (size > 0) {
+      ssize_t n = write(fd, p, size);
+      if (n <= 0) {
+        return false;
+      }
+      p += n;
+      size -= static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  std::string path_;               ///< The manifest file
+  void *handle_ = nullptr;         ///< The library handle, if identified
+  internal::DlLibraryId id_;       ///< The identity of the library
+  void *map_ = nullptr;            ///< The mapped file
+  size_t mapSize_ = 0;             ///< The size of the mapped file
+  const Entry *entries_ = nullptr; ///< The mapped entries, nullptr if invalid
+  const char *strings_ = nullptr;  ///< The mapped name table
+  size_t count_ = 0;               ///< The number of mapped entries
+
+  mutable std::mutex mu_; ///< Guards pending_
+  /// @brief The symbols resolved with dlsym since Open(), with their offsets
+  std::vector<std::pair<std::string, uint64_t>> pending_;
+};
+
+// DlLibBase::manifest_ only ever holds a DlSymbolManifest, made below
+
+inline bool DlLibBase::HasValidManifest() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return manifest_ != nullptr &&
+         static_cast<const DlSymbolManifest &>(*manifest_).IsValid();
+}
+
+inline bool DlLibBase::SelfDlUseManifest(std::string_view path) {
+  std::lock_guard<std::mutex> lock(mu_);
+  void *libptr = libptr_.load(std::memory_order_relaxed);
+  if (libptr == nullptr) {
+    return false;
+  }
+  auto manifest = std::make_unique<DlSymbolManifest>();
+  bool valid = manifest->Open(std::string(path), libptr);
+  if (manifest->IsBound(libptr)) {
+    manifest_ = std::move(manifest);
+  } else {
+    manifest_.reset(); // The library cannot be identified
+  }
+  return valid;
+}
+
+inline bool DlLibBase::SelfDlSaveManifest() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (manifest_ == nullptr) {
+    return false;
+  }
+  const auto &manifest = static_cast<const DlSymbolManifest &>(*manifest_);
+  return !manifest.IsDirty() || manifest.Save();
+}
+
+} // namespace dlutils
@@ -0,0 +1,168 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <dlfcn.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "dlutils/core.hpp"
+
+/// @brief Whether dlvsym is available (it is a GNU extension)
+#ifndef DLUTILS_HAS_DLVSYM
+#if defined(__GLIBC__) && defined(_GNU_SOURCE)
+#define DLUTILS_HAS_DLVSYM 1
+#else
+#define DLUTILS_HAS_DLVSYM 0
+#endif
+#endif
+
+namespace dlutils {
+
+namespace internal {
+
+/// @brief Resolve a specific version of a symbol with dlvsym
+///
+/// Versioned lookups are cached under the key "name@version", which cannot
+/// collide with an unversioned symbol name. Without dlvsym (see
+/// DLUTILS_HAS_DLVSYM), no version can be resolved and this returns nullptr.
+///
+/// @param cache The symbol cache
+/// @param handle The library handle
+/// @param name The symbol name (must be null-terminated)
+/// @param version The symbol version, e.g. OPENSSL_3.0.0
+/// @return The symbol address, nullptr if that version is missing
+inline void *ResolveVersion(DlSymbolCache &cache, void *handle,
+                            std::string_view name, std::string_view version) {
+  std::string key;
+  key.reserve(name.size() + 1 + version.size());
+  key.append(name).append(1, '@').append(version);
+  void *ptr = nullptr;
+  if (cache.Lookup(handle, key, &ptr)) {
+    return ptr;
+  }
+#if DLUTILS_HAS_DLVSYM
+  ptr = dlvsym(handle, name.data(), key.c_str() + name.size() + 1);
+#endif
+  cache.Insert(handle, key, ptr);
+  return ptr;
+}
+
+/// @brief The versions a DlLibBase bound with SelfDlVSym
+struct DlBoundVersions : DlLibExtension {
+  /// @brief Record the version a symbol was bound to
+  /// @param funName The interned name of the symbol
+  /// @param version The interned version, empty for the default version
+  void Record(std::string_view funName, std::string_view version) {
+    for (auto &bound : versions) {
+      if (bound.first == funName) {
+        bound.second = version;
+        return;
+      }
+    }
+    versions.emplace_back(funName, version);
+  }
+
+  /// @brief The (name, version) pairs, both interned
+  std::vector<std::pair<std::string_view, std::string_view>> versions;
+};
+
+} // namespace internal
+
+template <class R, class... Args>
+bool DlLibBase::SelfDlVSym(std::string_view funName,
+                           const std::vector<std::string_view> &versions,
+                           DlFun<R, Args...> &outFun) {
+  std::lock_guard<std::mutex> lock(mu_);
+  void *libptr = libptr_.load(std::memory_order_relaxed);
+  if (libptr == nullptr || funName.empty()) {
+    return false;
+  }
+
+  funName = internal::InternName(funName);
+  auto &cache = internal::DlSymbolCache::GetInstance();
+  std::string_view version;
+  auto resolve = [&](auto &name) {
+    for (std::string_view v : versions) {
+      if (void *ptr = internal::ResolveVersion(cache, libptr, funName, v)) {
+        version = internal::InternName(v);
+        if (loadLog_ != nullptr) {
+          // Log the version that got bound
+          name = internal::InternName(
+              internal::FormatString(funName, "@", version));
+        }
+        return ptr;
+      }
+    }
+    return cache.Resolve(libptr, funName);
+  };
+  // Only the loaded library is searched, so only its errors are reported
+  auto explain = [&] {
+    std::string error;
+    dlerror();
+#if DLUTILS_HAS_DLVSYM
+    for (std::string_view v : versions) {
+      internal::AppendDlError(
+          error, dlvsym(libptr, funName.data(), std::string(v).c_str()) ==
+                     nullptr);
+    }
+#endif
+    internal::AppendDlError(error, dlsym(libptr, funName.data()) == nullptr);
+    return error;
+  };
+  void *funPtr = ResolveLogged(funName, resolve, explain);
+  if (versions_ == nullptr) {
+    versions_ = std::make_unique<internal::DlBoundVersions>();
+  }
+  static_cast<internal::DlBoundVersions &>(*versions_).Record(funName,
+                                                              version);
+  PublishSymbol(funName, funPtr, outFun);
+  return true;
+}
+
+inline std::string DlLibBase::GetBoundVersion(std::string_view funName) const {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (versions_ == nullptr) {
+    return std::string();
+  }
+  const auto &bound = static_cast<const internal::DlBoundVersions &>(*versions_);
+  for (const auto &entry : bound.versions) {
+    if (entry.first == funName) {
+      return std::string(entry.second);
+    }
+  }
+  return std::string();
+}
+
+} // namespace dlutils
+
+/// @brief Macro to simplify loading versioned symbols
+///
+/// Usage: DLUTILS_SELF_DLVSYM(function_name, "VERS_2", "VERS_1")
+/// Expands to: SelfDlVSym("function_name", {"VERS_2", "VERS_1"}, function_name)
+#define DLUTILS_SELF_DLVSYM(NAME, ...) SelfDlVSym(#NAME, {__VA_ARGS__}, NAME)
@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// The dlutils API as a C++20 named module (see DLUTILS_BUILD_MODULE).
+//
+// The headers are compiled once into the module interface, and importers do
+// not parse them again. Macros cannot be exported: code that sets or reads
+// the DLUTILS_* configuration macros (e.g. DLUTILS_ENABLE_INSTRUMENTATION)
+// must include the headers instead, and must not mix both ways in a program
+// whose translation units disagree on them.
+module;
+
+#include "dlutils/async.hpp"
+#include "dlutils/batch.hpp"
+#include "dlutils/dlutils.hpp"
+#include "dlutils/elf_symbols.hpp"
+#include "dlutils/load_report.hpp"
+#include "dlutils/registry.hpp"
+#include "dlutils/resource_pool.hpp"
+#include "dlutils/symbol_manifest.hpp"
+
+export module dlutils;
+
+export namespace dlutils {
+
+using dlutils::DlBatchFun;
+using dlutils::DlCallStats;
+using dlutils::DlCpuFeatures;
+using dlutils::DlFun;
+using dlutils::DlHook;
+using dlutils::DlLazyFun;
+using dlutils::DlLibBase;
+using dlutils::DlLibGroup;
+using dlutils::DlLibRegistry;
+using dlutils::DlLibSlot;
+using dlutils::DlLibStatus;
+using dlutils::DlLibVariant;
+using dlutils::DlLoadReport;
+using dlutils::DlOpenFlags;
+using dlutils::DlOpenReport;
+using dlutils::DlResourcePool;
+using dlutils::DlSymbolReport;
+using dlutils::DlSymbolSlots;
+using dlutils::DlSymEntry;
+using dlutils::DlThreadPool;
+using dlutils::DlUncheckedFun;
+using dlutils::GetCpuFeatures;
+using dlutils::GetLoadedLibraries;
+using dlutils::HasCpuFeatures;
+using dlutils::HasFlag;
+using dlutils::MakeDlSymEntry;
+using dlutils::ToDlOpenMode;
+using dlutils::operator|;
+using dlutils::operator&;
+
+} // namespace dlutils
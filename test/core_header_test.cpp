@@ -0,0 +1,97 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// The core header must build without iostreams, std::function or the thread
+// support of the optional headers, so it is included first, before gtest
+// pulls them in.
+#include "dlutils/core.hpp"
+
+#ifdef _GLIBCXX_SSTREAM
+#error "dlutils/core.hpp must not include <sstream>"
+#endif
+
+#ifdef _GLIBCXX_FUNCTIONAL
+#error "dlutils/core.hpp must not include <functional>"
+#endif
+
+#ifdef _GLIBCXX_FUTURE
+#error "dlutils/core.hpp must not include <future>"
+#endif
+
+#if defined(_GLIBCXX_THREAD) || defined(_GLIBCXX_CONDITION_VARIABLE)
+#error "dlutils/core.hpp must not include <thread> or <condition_variable>"
+#endif
+
+// Parse time: the opt-in state (hook tables, fallbacks, versions, the
+// library directory) and the heavier containers stay out of the core
+#if defined(_GLIBCXX_UNORDERED_MAP) || defined(_GLIBCXX_UNORDERED_SET)
+#error "dlutils/core.hpp must not include <unordered_map> or <unordered_set>"
+#endif
+
+#if defined(_GLIBCXX_SHARED_MUTEX) || defined(_GLIBCXX_BITSET)
+#error "dlutils/core.hpp must not include <shared_mutex> or <bitset>"
+#endif
+
+#if defined(_GLIBCXX_DEQUE) && !DLUTILS_ENABLE_INSTRUMENTATION
+#error "dlutils/core.hpp must not include <deque>"
+#endif
+
+#if defined(DLUTILS_HOOK_SLOTS) || defined(DLUTILS_HAS_DLVSYM)
+#error "dlutils/core.hpp must not include hook.hpp or versioning.hpp"
+#endif
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace dlutils {
+
+class CoreOnlyLib : public DlLibBase {
+public:
+  CoreOnlyLib() : DlLibBase("libz.so") {
+    SelfDlOpen();
+    SelfDlSym("zlibVersion", zlibVersion);
+  }
+
+  DlFun<const char *> zlibVersion;
+};
+
+TEST(CoreHeaderTest, LoadsAndCallsWithoutOptionalHeaders) {
+  CoreOnlyLib lib;
+  ASSERT_NE(lib.zlibVersion.Get(), nullptr);
+  EXPECT_NE(lib.zlibVersion(), nullptr);
+}
+
+TEST(CoreHeaderTest, FormatsErrorsWithoutStringStream) {
+  EXPECT_EQ(internal::FormatString("a", 1, ' ', 2.5, true), "a1 2.51");
+
+  DlFun<const char *> missing;
+  try {
+    missing();
+    FAIL() << "expected std::runtime_error";
+  } catch (const std::runtime_error &e) {
+    EXPECT_NE(std::string(e.what()).find("is nullptr"), std::string::npos);
+  }
+}
+
+} // namespace dlutils
@@ -20,10 +20,28 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include "dlutils/async.hpp"
 #include "dlutils/dlutils.hpp"
+#include "dlutils/elf_symbols.hpp"
+#include "dlutils/load_report.hpp"
+#include "dlutils/registry.hpp"
+#include "dlutils/symbol_manifest.hpp"
 #include "gtest/gtest.h"
 
+#include <dlfcn.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <memory>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace dlutils {
 
@@ -32,8 +50,24 @@ class ExtendedMockDlLib : public DlLibBase {
 public:
   explicit ExtendedMockDlLib(std::string_view lib) : DlLibBase(lib) {}
 
+  explicit ExtendedMockDlLib(const std::vector<DlLibVariant> &variants)
+      : DlLibBase(variants) {}
+
+  ExtendedMockDlLib(std::string_view lib, DlOpenFlags flags)
+      : DlLibBase(lib, flags) {}
+
   bool OpenLib() { return SelfDlOpen(); }
 
+  bool CloseLib() { return SelfDlClose(); }
+
+  template <class Loader> bool ReloadLib(std::string_view lib, Loader loader) {
+    return SelfDlReload(lib, loader);
+  }
+
+  template <class Loader> bool ReloadLib(Loader loader) {
+    return SelfDlReload(loader);
+  }
+
   template <class R, class... Args>
   bool LoadSymbol(std::string_view funName, DlFun<R, Args...> &outFun) {
     return SelfDlSym(funName, outFun);
@@ -41,9 +75,47 @@ public:
 
   bool CheckCache() { return CheckFunCache(); }
 
+  template <class R, class... Args>
+  bool LoadVersionedSymbol(std::string_view funName,
+                           const std::vector<std::string_view> &versions,
+                           DlFun<R, Args...> &outFun) {
+    return SelfDlVSym(funName, versions, outFun);
+  }
+
+  template <class R, class... Args>
+  bool LoadSymbolLazy(std::string_view funName, DlLazyFun<R, Args...> &outFun) {
+    return SelfDlSymLazy(funName, outFun);
+  }
+
+  template <class... Entries> bool LoadTable(const Entries &...entries) {
+    return SelfDlSymTable(entries...);
+  }
+
+  bool SealLib() { return Seal(); }
+
+  template <class Table> bool LoadGeneratedTable(Table &table) {
+    return SelfDlLoadTable(table);
+  }
+
+  bool UseManifest(std::string_view path) { return SelfDlUseManifest(path); }
+
+  bool SaveManifest() { return SelfDlSaveManifest(); }
+
+  bool AddFallback(std::string_view lib) { return SelfDlAddFallback(lib); }
+
+  bool UseElfLookup() { return SelfDlUseElfLookup(); }
+
+  void EnableLoadReport() { SelfDlEnableLoadReport(); }
+
   size_t CacheSize() { return GetFunCacheSize(); }
 };
 
+#define TEST_SYMBOLS(X)                                                        \
+  X(dlutils_missing_a, int, (int))                                             \
+  X(OpenSSL_version_num, unsigned long, ())
+
+DLUTILS_DEFINE_SYMBOL_TABLE(TestSymbols, TEST_SYMBOLS);
+
 // Tests for DlLibBase class with invalid library
 TEST(DlLibBaseExtendedTest, OpenInvalidLibrary) {
   ExtendedMockDlLib lib("libnonexistent.so");
@@ -131,6 +203,1465 @@ TEST(DlLibBaseExtendedTest, FunCacheSizeAfterMixedSuccessFailure) {
   EXPECT_TRUE(lib.CheckCache());
 }
 
+// Tests for sealing a library with a real and a missing symbol
+TEST(DlLibBaseExtendedTest, SealFailsWithMissingSymbol) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+
+  DlFun<unsigned long> version;
+  EXPECT_TRUE(lib.LoadSymbol("OpenSSL_version_num", version));
+  EXPECT_TRUE(lib.SealLib());
+  EXPECT_TRUE(lib.IsSealed());
+  EXPECT_GT(version.Unchecked()(), 0u);
+
+  // Loading a new symbol unseals the library until it is validated again
+  DlFun<int, int, int> missing;
+  EXPECT_TRUE(lib.LoadSymbol("dlutils_nonexistent_function", missing));
+  EXPECT_FALSE(lib.IsSealed());
+  EXPECT_FALSE(lib.SealLib());
+  EXPECT_FALSE(lib.IsSealed());
+  EXPECT_THROW(missing.Unchecked(), std::runtime_error);
+}
+
+// Tests for loading a symbol table without opening the library
+TEST(DlLibBaseExtendedTest, LoadTableWithNullLibPtr) {
+  ExtendedMockDlLib lib("libnonexistent.so");
+  DlFun<unsigned long> OpenSSL_version_num;
+  EXPECT_FALSE(lib.LoadTable(DLUTILS_SYM_ENTRY(OpenSSL_version_num)));
+  EXPECT_EQ(lib.CacheSize(), 0u);
+  EXPECT_EQ(OpenSSL_version_num.GetName(), "unknown");
+}
+
+// Tests for loading a symbol table in a single pass
+TEST(DlLibBaseExtendedTest, LoadTableReportsAllMissingSymbols) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+
+  DlFun<unsigned long> OpenSSL_version_num;
+  DlFun<int, int> dlutils_missing_a;
+  DlFun<void> dlutils_missing_b;
+  EXPECT_FALSE(lib.LoadTable(DLUTILS_SYM_ENTRY(dlutils_missing_a),
+                             DLUTILS_SYM_ENTRY(OpenSSL_version_num),
+                             DLUTILS_SYM_ENTRY(dlutils_missing_b)));
+
+  EXPECT_EQ(lib.CacheSize(), 3u);
+  EXPECT_FALSE(lib.CheckCache());
+  EXPECT_EQ(lib.GetMissingSymbols(),
+            (std::vector<std::string>{"dlutils_missing_a",
+                                      "dlutils_missing_b"}));
+
+  EXPECT_EQ(OpenSSL_version_num.GetName(), "OpenSSL_version_num");
+  EXPECT_GT(OpenSSL_version_num(), 0u);
+  EXPECT_EQ(dlutils_missing_a.GetName(), "dlutils_missing_a");
+  EXPECT_THROW(dlutils_missing_a(1), std::runtime_error);
+
+  // A table with only valid symbols clears the previous report
+  EXPECT_TRUE(lib.LoadTable(DLUTILS_SYM_ENTRY(OpenSSL_version_num)));
+  EXPECT_TRUE(lib.GetMissingSymbols().empty());
+}
+
+TEST(DlLibBaseExtendedTest, RebindingOverwritesItsEntry) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+
+  DlFun<unsigned long> OpenSSL_version_num;
+  DlFun<int, int> dlutils_missing_a;
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(lib.LoadSymbol("OpenSSL_version_num", OpenSSL_version_num));
+    EXPECT_TRUE(lib.LoadSymbol("dlutils_missing_a", dlutils_missing_a));
+    EXPECT_FALSE(lib.LoadTable(DLUTILS_SYM_ENTRY(OpenSSL_version_num),
+                               DLUTILS_SYM_ENTRY(dlutils_missing_a)));
+  }
+  EXPECT_EQ(lib.CacheSize(), 2u);
+  EXPECT_EQ(lib.GetMissingSymbols(),
+            std::vector<std::string>{"dlutils_missing_a"});
+
+  // Binding the missing DlFun to a symbol that resolves clears its failure
+  EXPECT_TRUE(lib.LoadSymbol("OpenSSL_version_num", dlutils_missing_a));
+  EXPECT_EQ(lib.CacheSize(), 2u);
+  EXPECT_TRUE(lib.GetMissingSymbols().empty());
+  EXPECT_TRUE(lib.SealLib());
+
+  TestSymbols table;
+  EXPECT_FALSE(lib.LoadGeneratedTable(table));
+  EXPECT_FALSE(lib.LoadGeneratedTable(table));
+  EXPECT_EQ(lib.CacheSize(), 4u);
+}
+
+// Tests for tables generated by DLUTILS_DEFINE_SYMBOL_TABLE
+TEST(DlLibBaseExtendedTest, GeneratedTableLayout) {
+  static_assert(TestSymbols::kSize == 2);
+  static_assert(TestSymbols::kNames[TestSymbols::kOpenSSL_version_num] ==
+                "OpenSSL_version_num");
+  static_assert(alignof(DlSymbolSlots<TestSymbols::kSize>) == 64,
+                "The pointers should start on a cache line");
+  TestSymbols table;
+  EXPECT_EQ(table.slots.Get<int(int)>(TestSymbols::kdlutils_missing_a),
+            nullptr);
+  EXPECT_THROW(table.OpenSSL_version_num(), std::runtime_error);
+}
+
+TEST(DlLibBaseExtendedTest, LoadGeneratedTableWithNullLibPtr) {
+  ExtendedMockDlLib lib("libnonexistent.so");
+  TestSymbols table;
+  EXPECT_FALSE(lib.LoadGeneratedTable(table));
+  EXPECT_EQ(lib.CacheSize(), 0u);
+}
+
+TEST(DlLibBaseExtendedTest, LoadGeneratedTable) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+
+  TestSymbols table;
+  EXPECT_FALSE(lib.LoadGeneratedTable(table));
+  EXPECT_EQ(lib.CacheSize(), 2u);
+  EXPECT_FALSE(lib.SealLib());
+  EXPECT_EQ(lib.GetMissingSymbols(),
+            std::vector<std::string>{"dlutils_missing_a"});
+
+  EXPECT_GT(table.OpenSSL_version_num(), 0u);
+  try {
+    table.dlutils_missing_a(1);
+    FAIL() << "Expected std::runtime_error";
+  } catch (const std::runtime_error &e) {
+    EXPECT_NE(std::string(e.what()).find("dlutils_missing_a"),
+              std::string::npos);
+  }
+}
+
+// Tests for versioned symbols
+TEST(DlLibBaseExtendedTest, VersionedSymbolWithNullLibPtr) {
+  ExtendedMockDlLib lib("libnonexistent.so");
+  DlFun<unsigned long> func;
+  EXPECT_FALSE(
+      lib.LoadVersionedSymbol("OpenSSL_version_num", {"OPENSSL_3.0.0"}, func));
+  EXPECT_EQ(func.GetName(), "unknown");
+}
+
+TEST(DlLibBaseExtendedTest, VersionedSymbolPrefersListedVersions) {
+  if (!DLUTILS_HAS_DLVSYM) {
+    GTEST_SKIP() << "dlvsym is not available";
+  }
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+  DlFun<unsigned long> reference;
+  ASSERT_TRUE(lib.LoadSymbol("OpenSSL_version_num", reference));
+
+  // The first version is not exported, so the second one is bound
+  DlFun<unsigned long> func;
+  ASSERT_TRUE(lib.LoadVersionedSymbol(
+      "OpenSSL_version_num", {"DLUTILS_MISSING_1.0", "OPENSSL_3.0.0"}, func));
+  EXPECT_EQ(lib.GetBoundVersion("OpenSSL_version_num"), "OPENSSL_3.0.0");
+  EXPECT_EQ(func.Get(), reference.Get());
+  EXPECT_EQ(func(), reference());
+  EXPECT_TRUE(lib.SealLib());
+}
+
+TEST(DlLibBaseExtendedTest, VersionedSymbolFallsBackToDefault) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+  DlFun<unsigned long> func;
+  ASSERT_TRUE(lib.LoadVersionedSymbol("OpenSSL_version_num",
+                                      {"DLUTILS_MISSING_1.0"}, func));
+  EXPECT_EQ(lib.GetBoundVersion("OpenSSL_version_num"), "");
+  EXPECT_GT(func(), 0u);
+
+  DlFun<void> missing;
+  ASSERT_TRUE(lib.LoadVersionedSymbol("dlutils_missing_a",
+                                      {"DLUTILS_MISSING_1.0"}, missing));
+  EXPECT_EQ(lib.GetMissingSymbols(),
+            std::vector<std::string>{"dlutils_missing_a"});
+  EXPECT_THROW(missing(), std::runtime_error);
+}
+
+// Tests for unloading. These use libraries that nothing else in the test
+// binary loads; libssl.so would not do, it pins itself with RTLD_NODELETE
+bool IsResident(const char *lib) {
+  void *handle = dlopen(lib, RTLD_NOW | RTLD_NOLOAD);
+  if (handle != nullptr) {
+    dlclose(handle);
+  }
+  return handle != nullptr;
+}
+
+TEST(DlLibBaseExtendedTest, IsMoveOnly) {
+  static_assert(!std::is_copy_constructible_v<ExtendedMockDlLib>);
+  static_assert(!std::is_copy_assignable_v<ExtendedMockDlLib>);
+  static_assert(std::is_move_constructible_v<ExtendedMockDlLib>);
+  static_assert(std::is_move_assignable_v<ExtendedMockDlLib>);
+}
+
+TEST(DlLibBaseExtendedTest, DestructorClosesLibrary) {
+  ASSERT_FALSE(IsResident("libz.so"));
+  {
+    ExtendedMockDlLib lib("libz.so");
+    ASSERT_TRUE(lib.OpenLib());
+    EXPECT_TRUE(IsResident("libz.so"));
+  }
+  EXPECT_FALSE(IsResident("libz.so"));
+}
+
+TEST(DlLibBaseExtendedTest, SecondOpenKeepsOneHandle) {
+  ASSERT_FALSE(IsResident("libz.so"));
+  {
+    ExtendedMockDlLib lib("libz.so");
+    ASSERT_TRUE(lib.OpenLib());
+    EXPECT_TRUE(lib.OpenLib()); // Already open: succeeds, no new reference
+    EXPECT_EQ(lib.GetLoadedLib(), "libz.so");
+  }
+  EXPECT_FALSE(IsResident("libz.so"));
+
+  // It can be opened again once it was closed
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  ASSERT_TRUE(lib.CloseLib());
+  EXPECT_TRUE(lib.OpenLib());
+  EXPECT_TRUE(lib.CloseLib());
+  EXPECT_FALSE(IsResident("libz.so"));
+}
+
+TEST(DlLibBaseExtendedTest, NoDeletePinsLibrary) {
+  {
+    ExtendedMockDlLib lib("libexpat.so",
+                          DlOpenFlags::kDefault | DlOpenFlags::kNoDelete);
+    ASSERT_TRUE(lib.OpenLib());
+  }
+  EXPECT_TRUE(IsResident("libexpat.so"));
+}
+
+TEST(DlLibBaseExtendedTest, MoveTransfersHandle) {
+  ExtendedMockDlLib a("libz.so");
+  ASSERT_TRUE(a.OpenLib());
+  DlFun<const char *> zlibVersion;
+  ASSERT_TRUE(a.LoadSymbol("zlibVersion", zlibVersion));
+  ASSERT_TRUE(a.SealLib());
+
+  ExtendedMockDlLib b(std::move(a));
+  EXPECT_EQ(a.GetLoadedLib(), "");
+  EXPECT_FALSE(a.CloseLib());
+  EXPECT_EQ(b.GetLoadedLib(), "libz.so");
+  // The bindings name the functions of a, so they are not taken over
+  EXPECT_FALSE(b.IsSealed());
+  EXPECT_EQ(b.CacheSize(), 0u);
+  EXPECT_NE(zlibVersion(), nullptr);
+  ASSERT_TRUE(b.LoadSymbol("zlibVersion", zlibVersion));
+  EXPECT_TRUE(b.SealLib());
+
+  // The library held by the target of a move assignment is closed
+  ExtendedMockDlLib c("libffi.so");
+  ASSERT_TRUE(c.OpenLib());
+  c = std::move(b);
+  EXPECT_FALSE(IsResident("libffi.so"));
+  EXPECT_EQ(c.GetLoadedLib(), "libz.so");
+  EXPECT_NE(zlibVersion(), nullptr);
+  EXPECT_TRUE(c.CloseLib());
+  EXPECT_FALSE(IsResident("libz.so"));
+}
+
+TEST(DlLibBaseExtendedTest, RebindAfterMoveKeepsOneEntry) {
+  ExtendedMockDlLib a("libz.so");
+  ASSERT_TRUE(a.OpenLib());
+  DlFun<unsigned long> crc32;
+  DlFun<int, int> dlutils_missing_a;
+  ASSERT_TRUE(a.LoadSymbol("crc32", crc32));
+  ASSERT_TRUE(a.LoadSymbol("dlutils_missing_a", dlutils_missing_a));
+
+  ExtendedMockDlLib b(std::move(a));
+  EXPECT_EQ(b.GetMissingSymbols(), std::vector<std::string>{});
+  for (int i = 0; i < 2; i++) {
+    ASSERT_TRUE(b.LoadSymbol("crc32", crc32));
+    ASSERT_TRUE(b.LoadSymbol("dlutils_missing_a", dlutils_missing_a));
+    EXPECT_EQ(b.CacheSize(), 2u);
+    EXPECT_EQ(b.GetMissingSymbols(),
+              std::vector<std::string>{"dlutils_missing_a"});
+  }
+  EXPECT_TRUE(a.GetMissingSymbols().empty());
+}
+
+TEST(DlLibBaseExtendedTest, GroupUnloadsInDependencyOrder) {
+  ExtendedMockDlLib base("libz.so");
+  ExtendedMockDlLib dependent("libffi.so");
+  ExtendedMockDlLib outsider("libcrypto.so");
+  ASSERT_TRUE(base.OpenLib());
+  ASSERT_TRUE(dependent.OpenLib());
+
+  DlLibGroup group;
+  group.Add(base);
+  EXPECT_THROW(group.Add(base), std::runtime_error);
+  EXPECT_THROW(group.Add(dependent, {&outsider}), std::runtime_error);
+  group.Add(dependent, {&base});
+  EXPECT_EQ(group.Size(), 2u);
+
+  EXPECT_EQ(group.UnloadAll(), 2u);
+  EXPECT_EQ(group.Size(), 0u);
+  EXPECT_FALSE(IsResident("libz.so"));
+  EXPECT_FALSE(IsResident("libffi.so"));
+}
+
+// Tests for hot reload
+// Tests for the on-disk symbol manifest
+namespace {
+
+std::string ManifestPath(const char *test) {
+  return "/tmp/dlutils_" + std::string(test) + "_" +
+         std::to_string(getpid()) + ".manifest";
+}
+
+} // namespace
+
+TEST(DlLibBaseExtendedTest, ManifestWithoutOpenLibrary) {
+  ExtendedMockDlLib lib("libz.so");
+  EXPECT_FALSE(lib.UseManifest(ManifestPath("closed")));
+  EXPECT_FALSE(lib.SaveManifest());
+  EXPECT_FALSE(lib.HasValidManifest());
+}
+
+TEST(DlLibBaseExtendedTest, ManifestRoundTrip) {
+  const std::string path = ManifestPath("roundtrip");
+  std::remove(path.c_str());
+  std::string version;
+  {
+    // No manifest yet: resolved with dlsym, then written out
+    ExtendedMockDlLib lib("libz.so");
+    ASSERT_TRUE(lib.OpenLib());
+    EXPECT_FALSE(lib.UseManifest(path));
+    EXPECT_FALSE(lib.HasValidManifest());
+    DlFun<const char *> zlibVersion;
+    DlFun<unsigned long, unsigned long, const unsigned char *, unsigned> crc32;
+    ASSERT_TRUE(lib.LoadSymbol("zlibVersion", zlibVersion));
+    ASSERT_TRUE(lib.LoadSymbol("crc32", crc32));
+    version = zlibVersion(); // libz may be mapped elsewhere once closed
+    EXPECT_TRUE(lib.SaveManifest());
+  }
+
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  ASSERT_TRUE(lib.UseManifest(path));
+  EXPECT_TRUE(lib.HasValidManifest());
+  DlFun<const char *> fromManifest;
+  ASSERT_TRUE(lib.LoadSymbol("zlibVersion", fromManifest));
+  void *handle = dlopen("libz.so", RTLD_NOW | RTLD_NOLOAD);
+  ASSERT_NE(handle, nullptr);
+  EXPECT_EQ(reinterpret_cast<void *>(fromManifest.Get()),
+            dlsym(handle, "zlibVersion"));
+  EXPECT_EQ(fromManifest(), version);
+
+  DlSymbolManifest manifest;
+  ASSERT_TRUE(manifest.Open(path, handle));
+  EXPECT_EQ(manifest.Size(), 2u);
+  EXPECT_EQ(manifest.Find("crc32"), dlsym(handle, "crc32"));
+  EXPECT_EQ(manifest.Find("missing"), nullptr);
+  dlclose(handle);
+
+  // Nothing new was resolved, so nothing needs writing
+  EXPECT_TRUE(lib.SaveManifest());
+  std::remove(path.c_str());
+}
+
+TEST(DlLibBaseExtendedTest, ManifestSkipsDependencySymbols) {
+  const std::string path = ManifestPath("deps");
+  std::remove(path.c_str());
+  {
+    ExtendedMockDlLib lib("libz.so");
+    ASSERT_TRUE(lib.OpenLib());
+    lib.UseManifest(path);
+    DlFun<const char *> zlibVersion;
+    DlFun<void *, size_t> malloc; // Found in libc through libz's handle
+    ASSERT_TRUE(lib.LoadSymbol("zlibVersion", zlibVersion));
+    ASSERT_TRUE(lib.LoadSymbol("malloc", malloc));
+    ASSERT_NE(malloc.Get(), nullptr);
+    EXPECT_TRUE(lib.SaveManifest());
+  }
+  // The library may be mapped at another base now, offsets still apply
+  void *handle = dlopen("libz.so", RTLD_NOW);
+  ASSERT_NE(handle, nullptr);
+  DlSymbolManifest manifest;
+  ASSERT_TRUE(manifest.Open(path, handle));
+  EXPECT_EQ(manifest.Size(), 1u);
+  EXPECT_EQ(manifest.Find("malloc"), nullptr);
+  dlclose(handle);
+  std::remove(path.c_str());
+}
+
+TEST(DlLibBaseExtendedTest, ManifestRejectsOtherLibrary) {
+  const std::string path = ManifestPath("other");
+  {
+    ExtendedMockDlLib lib("libz.so");
+    ASSERT_TRUE(lib.OpenLib());
+    lib.UseManifest(path);
+    DlFun<const char *> zlibVersion;
+    ASSERT_TRUE(lib.LoadSymbol("zlibVersion", zlibVersion));
+    ASSERT_TRUE(lib.SaveManifest());
+  }
+  ExtendedMockDlLib lib("libffi.so");
+  ASSERT_TRUE(lib.OpenLib());
+  EXPECT_FALSE(lib.UseManifest(path));
+  EXPECT_FALSE(lib.HasValidManifest());
+  DlFun<void> ffiCall;
+  ASSERT_TRUE(lib.LoadSymbol("ffi_call", ffiCall));
+  EXPECT_NE(ffiCall.Get(), nullptr);
+  std::remove(path.c_str());
+}
+
+TEST(DlLibBaseExtendedTest, ManifestRejectsCorruptFile) {
+  const std::string path = ManifestPath("corrupt");
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "DLUSYMS garbage that is not a manifest";
+  }
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  EXPECT_FALSE(lib.UseManifest(path));
+  DlFun<const char *> zlibVersion;
+  ASSERT_TRUE(lib.LoadSymbol("zlibVersion", zlibVersion));
+  EXPECT_NE(zlibVersion.Get(), nullptr);
+  // The fresh manifest replaces the corrupt file
+  EXPECT_TRUE(lib.SaveManifest());
+  EXPECT_TRUE(lib.UseManifest(path));
+  std::remove(path.c_str());
+}
+
+TEST(DlLibBaseExtendedTest, ManifestRejectsOffsetOutsideText) {
+  const std::string path = ManifestPath("offset");
+  {
+    ExtendedMockDlLib lib("libz.so");
+    ASSERT_TRUE(lib.OpenLib());
+    lib.UseManifest(path);
+    DlFun<const char *> zlibVersion;
+    ASSERT_TRUE(lib.LoadSymbol("zlibVersion", zlibVersion));
+    ASSERT_TRUE(lib.SaveManifest());
+  }
+  {
+    // Point the only entry far past the end of the library
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    const uint64_t offset = uint64_t{1} << 40;
+    file.seekp(sizeof(DlSymbolManifest::Header));
+    file.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+  }
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  EXPECT_FALSE(lib.UseManifest(path));
+  EXPECT_FALSE(lib.HasValidManifest());
+  DlFun<const char *> zlibVersion;
+  ASSERT_TRUE(lib.LoadSymbol("zlibVersion", zlibVersion));
+  void *handle = dlopen("libz.so", RTLD_NOW | RTLD_NOLOAD);
+  ASSERT_NE(handle, nullptr);
+  EXPECT_EQ(reinterpret_cast<void *>(zlibVersion.Get()),
+            dlsym(handle, "zlibVersion"));
+  dlclose(handle);
+  std::remove(path.c_str());
+}
+
+// Tests for the GNU hash table lookup
+TEST(DlLibBaseExtendedTest, ElfSymbolsMatchDlsym) {
+  const std::vector<std::pair<const char *, std::vector<std::string_view>>>
+      libs = {
+          {"libz.so", {"zlibVersion", "crc32", "adler32", "deflate"}},
+          {"libcrypto.so",
+           {"EVP_MD_CTX_new", "EVP_sha256", "EVP_DigestInit_ex",
+            "EVP_DigestUpdate", "EVP_DigestFinal_ex", "EVP_MD_CTX_free"}},
+          // realpath has a hidden old version next to the default one
+          {"libc.so.6", {"realpath", "getpid", "environ"}},
+      };
+  for (const auto &lib : libs) {
+    void *handle = dlopen(lib.first, RTLD_NOW);
+    ASSERT_NE(handle, nullptr) << lib.first;
+    internal::DlElfSymbols symbols;
+    ASSERT_TRUE(symbols.Open(handle)) << lib.first;
+    for (std::string_view name : lib.second) {
+      EXPECT_EQ(symbols.Lookup(name), dlsym(handle, name.data())) << name;
+    }
+    EXPECT_EQ(symbols.Lookup("no_such_symbol_here"), nullptr);
+    dlclose(handle);
+  }
+}
+
+TEST(DlLibBaseExtendedTest, ElfSymbolsSkipDependencies) {
+  void *handle = dlopen("libz.so", RTLD_NOW);
+  ASSERT_NE(handle, nullptr);
+  internal::DlElfSymbols symbols;
+  ASSERT_TRUE(symbols.Open(handle));
+  // malloc comes from libc, which dlsym also searches
+  EXPECT_EQ(symbols.Lookup("malloc"), nullptr);
+  EXPECT_NE(dlsym(handle, "malloc"), nullptr);
+  dlclose(handle);
+}
+
+TEST(DlLibBaseExtendedTest, ElfSymbolsBatchMatchesLookup) {
+  void *handle = dlopen("libcrypto.so", RTLD_NOW);
+  ASSERT_NE(handle, nullptr);
+  internal::DlElfSymbols symbols;
+  ASSERT_TRUE(symbols.Open(handle));
+  std::vector<std::string> storage;
+  for (const char *name :
+       {"EVP_MD_CTX_new", "EVP_sha1", "EVP_sha256", "EVP_sha512", "EVP_md5",
+        "missing_a", "missing_b", "OPENSSL_init_crypto", "ERR_get_error"}) {
+    for (int i = 0; i < 5; i++) {
+      storage.push_back(name); // More than one chunk of the batch
+    }
+  }
+  std::vector<std::string_view> names(storage.begin(), storage.end());
+  std::vector<void *> out(names.size());
+  symbols.LookupBatch(names.data(), out.data(), names.size());
+  for (size_t i = 0; i < names.size(); i++) {
+    EXPECT_EQ(out[i], symbols.Lookup(names[i])) << names[i];
+  }
+  EXPECT_NE(out.front(), nullptr);
+  dlclose(handle);
+}
+
+TEST(DlLibBaseExtendedTest, ElfLookupIsOptIn) {
+  ExtendedMockDlLib plain("libz.so");
+  ASSERT_TRUE(plain.OpenLib());
+  EXPECT_FALSE(plain.UsesElfLookup());
+
+  ExtendedMockDlLib lib("libz.so");
+  EXPECT_FALSE(lib.UseElfLookup()); // Not open yet
+  ASSERT_TRUE(lib.OpenLib());
+  ASSERT_TRUE(lib.UseElfLookup());
+  EXPECT_TRUE(lib.UsesElfLookup());
+  DlFun<const char *> zlibVersion;
+  DlFun<unsigned long, unsigned long, const unsigned char *, unsigned> crc32;
+  DlFun<void *, size_t> malloc;
+  DlFun<void> missing;
+  EXPECT_FALSE(lib.LoadTable(DLUTILS_SYM_ENTRY(zlibVersion),
+                             DLUTILS_SYM_ENTRY(crc32),
+                             DLUTILS_SYM_ENTRY(malloc),
+                             DLUTILS_SYM_ENTRY(missing)));
+  EXPECT_EQ(lib.GetMissingSymbols(), std::vector<std::string>{"missing"});
+  // The dependency symbol still resolves, through the dlsym fallback
+  void *handle = dlopen("libz.so", RTLD_NOW | RTLD_NOLOAD);
+  EXPECT_EQ(reinterpret_cast<void *>(malloc.Get()), dlsym(handle, "malloc"));
+  EXPECT_EQ(reinterpret_cast<void *>(crc32.Get()), dlsym(handle, "crc32"));
+  EXPECT_EQ(reinterpret_cast<void *>(zlibVersion.Get()),
+            dlsym(handle, "zlibVersion"));
+  dlclose(handle);
+
+  // A reload drops the lookup, as it drops the manifest
+  EXPECT_TRUE(lib.ReloadLib([]() { return true; }));
+  EXPECT_FALSE(lib.UsesElfLookup());
+  ASSERT_TRUE(lib.UseElfLookup());
+
+  EXPECT_TRUE(lib.CloseLib());
+  EXPECT_FALSE(lib.UsesElfLookup());
+}
+
+TEST(DlLibBaseExtendedTest, ReloadWithoutOpenLibrary) {
+  ExtendedMockDlLib lib("libnonexistent.so");
+  bool called = false;
+  EXPECT_FALSE(lib.ReloadLib([&called]() { return called = true; }));
+  EXPECT_FALSE(called);
+}
+
+TEST(DlLibBaseExtendedTest, ReloadSameLibrary) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+  DlFun<unsigned long> func;
+  ASSERT_TRUE(lib.LoadSymbol("OpenSSL_version_num", func));
+  const unsigned long version = func();
+
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(lib.ReloadLib(
+        [&]() { return lib.LoadSymbol("OpenSSL_version_num", func); }));
+  }
+  // The cache is reset instead of growing, and the handle stays usable
+  EXPECT_EQ(lib.CacheSize(), 1u);
+  EXPECT_TRUE(lib.CheckCache());
+  EXPECT_EQ(func(), version);
+  EXPECT_TRUE(lib.CloseLib());
+}
+
+TEST(DlLibBaseExtendedTest, ReloadPublishesLoaderAsOneSet) {
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  DlFun<unsigned long, unsigned long, const unsigned char *, unsigned> crc32;
+  DlFun<unsigned long, unsigned long, const unsigned char *, unsigned> adler32;
+  ASSERT_TRUE(lib.LoadSymbol("crc32", crc32));
+  ASSERT_TRUE(lib.LoadSymbol("adler32", adler32));
+  const uint64_t generation = lib.GetGeneration();
+
+  // A guard created between two SelfDlSym calls of the loader waits until the
+  // loader is done, instead of seeing crc32 rebound and adler32 not yet
+  std::future<bool> reader;
+  std::atomic<bool> entered{false};
+  EXPECT_TRUE(lib.ReloadLib([&]() {
+    lib.LoadSymbol("crc32", crc32);
+    reader = std::async(std::launch::async, [&]() {
+      DlLibBase::ReadGuard guard(lib);
+      entered = true;
+      return crc32.Get() != nullptr && adler32.Get() != nullptr;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(entered.load());
+    return lib.LoadSymbol("adler32", adler32);
+  }));
+  EXPECT_TRUE(reader.get());
+  EXPECT_EQ(lib.GetGeneration(), generation + 1);
+  EXPECT_EQ(lib.CacheSize(), 2u);
+}
+
+TEST(DlLibBaseExtendedTest, ReloadSwitchesLibrary) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+  DlLazyFun<unsigned long> lazy;
+  ASSERT_TRUE(lib.LoadSymbolLazy("OpenSSL_version_num", lazy));
+  EXPECT_GT(lazy(), 0u);
+  EXPECT_TRUE(lazy.IsBound());
+
+  // A library that cannot be opened keeps the old one
+  EXPECT_FALSE(lib.ReloadLib("libdlutils_missing.so", []() { return true; }));
+  EXPECT_EQ(lib.GetLoadedLib(), "libcrypto.so");
+  EXPECT_TRUE(lazy.IsBound());
+  // ... and keeps reopening the old name, by reload or after a close
+  EXPECT_TRUE(lib.ReloadLib([]() { return true; }));
+  EXPECT_EQ(lib.GetLoadedLib(), "libcrypto.so");
+  ASSERT_TRUE(lib.CloseLib());
+  ASSERT_TRUE(lib.OpenLib());
+  EXPECT_EQ(lib.GetLoadedLib(), "libcrypto.so");
+  ASSERT_TRUE(lib.LoadSymbolLazy("OpenSSL_version_num", lazy));
+
+  DlFun<int, uint64_t, const void *> init;
+  EXPECT_TRUE(lib.ReloadLib("libssl.so", [&]() {
+    return lib.LoadSymbol("OPENSSL_init_ssl", init);
+  }));
+  EXPECT_EQ(lib.GetLoadedLib(), "libssl.so");
+  EXPECT_NE(init.Get(), nullptr);
+  EXPECT_EQ(lib.GetMissingSymbols(), std::vector<std::string>{});
+  // Lazy functions resolve again, from the new library (libssl.so pulls in
+  // libcrypto.so, so it still finds OpenSSL_version_num)
+  EXPECT_FALSE(lazy.IsBound());
+  EXPECT_GT(lazy(), 0u);
+}
+
+// Tests for CPU-feature-aware variant selection
+// Tests for the fallback libraries and the negative cache
+TEST(DlLibBaseExtendedTest, FallbackResolvesMissingSymbols) {
+  ASSERT_FALSE(IsResident("libffi.so"));
+  {
+    ExtendedMockDlLib lib("libz.so");
+    ASSERT_TRUE(lib.OpenLib());
+    EXPECT_FALSE(lib.AddFallback("libdlutils_nonexistent.so"));
+    ASSERT_TRUE(lib.AddFallback("libffi.so"));
+    ASSERT_TRUE(lib.AddFallback("libffi.so")); // Already a fallback
+    EXPECT_EQ(lib.GetFallbackLibs(),
+              std::vector<std::string_view>{"libffi.so"});
+
+    DlFun<const char *> zlibVersion;
+    DlFun<void> ffi_call;
+    DlFun<void> dlutils_missing;
+    EXPECT_FALSE(lib.LoadTable(DLUTILS_SYM_ENTRY(zlibVersion),
+                               DLUTILS_SYM_ENTRY(ffi_call),
+                               DLUTILS_SYM_ENTRY(dlutils_missing)));
+    EXPECT_EQ(lib.GetMissingSymbols(),
+              std::vector<std::string>{"dlutils_missing"});
+    void *ffi = dlopen("libffi.so", RTLD_NOW | RTLD_NOLOAD);
+    ASSERT_NE(ffi, nullptr);
+    EXPECT_EQ(reinterpret_cast<void *>(ffi_call.Get()),
+              dlsym(ffi, "ffi_call"));
+    dlclose(ffi);
+
+    DlFun<void> ffi_prep_cif;
+    ASSERT_TRUE(lib.LoadSymbol("ffi_prep_cif", ffi_prep_cif));
+    EXPECT_NE(ffi_prep_cif.Get(), nullptr);
+
+    EXPECT_TRUE(lib.CloseLib());
+    EXPECT_TRUE(lib.GetFallbackLibs().empty());
+    EXPECT_FALSE(IsResident("libffi.so"));
+  }
+}
+
+TEST(DlLibBaseExtendedTest, NegativeCacheSurvivesReload) {
+  auto &cache = internal::DlSymbolCache::GetInstance();
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  DlFun<void> missing;
+  auto load = [&]() { return lib.LoadSymbol("dlutils_missing_z", missing); };
+  ASSERT_TRUE(load());
+  void *handle = dlopen("libz.so", RTLD_NOW | RTLD_NOLOAD);
+  ASSERT_NE(handle, nullptr);
+  void *cached = &cache;
+  EXPECT_TRUE(cache.Lookup(handle, "dlutils_missing_z", &cached));
+  EXPECT_EQ(cached, nullptr);
+
+  // Reopening the same handle keeps the negative entry
+  EXPECT_TRUE(lib.ReloadLib(load));
+  EXPECT_EQ(missing.Get(), nullptr);
+  EXPECT_TRUE(cache.Lookup(handle, "dlutils_missing_z", &cached));
+  dlclose(handle);
+
+  // Closing the handle drops it
+  EXPECT_TRUE(lib.CloseLib());
+  handle = dlopen("libz.so", RTLD_NOW);
+  EXPECT_FALSE(cache.Lookup(handle, "dlutils_missing_z", &cached));
+  dlclose(handle);
+}
+
+// Tests for the library registry and the loaded library listing
+namespace {
+
+class RegistryZlib : public DlLibBase {
+public:
+  RegistryZlib() : DlLibBase("libz.so") {
+    SelfDlOpen();
+    SelfDlSymTable(DLUTILS_SYM_ENTRY(zlibVersion), DLUTILS_SYM_ENTRY(crc32));
+    Seal();
+  }
+
+  DlFun<const char *> zlibVersion;
+  DlFun<unsigned long, unsigned long, const unsigned char *, unsigned> crc32;
+};
+
+class RegistryFfi : public DlLibBase {
+public:
+  RegistryFfi() : DlLibBase("libffi.so") {
+    SelfDlOpen();
+    SelfDlSymTable(DLUTILS_SYM_ENTRY(ffi_call),
+                   DLUTILS_SYM_ENTRY(dlutils_ffi_missing));
+    Seal();
+  }
+
+  DlFun<void> ffi_call;
+  DlFun<void> dlutils_ffi_missing;
+};
+
+class RegistryThrows : public DlLibBase {
+public:
+  RegistryThrows() : DlLibBase("libdlutils_nonexistent.so") {
+    throw std::runtime_error("RegistryThrows");
+  }
+};
+
+const DlLibStatus *FindStatus(const std::vector<DlLibStatus> &libs,
+                              const std::string &name) {
+  for (const auto &lib : libs) {
+    if (lib.name == name) {
+      return &lib;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+TEST(DlLibBaseExtendedTest, RegistryLifetime) {
+  using Libraries = DlLibRegistry<RegistryZlib, RegistryFfi>;
+  static_assert(Libraries::kSize == 2);
+  EXPECT_FALSE(Libraries::IsInitialized());
+  EXPECT_EQ(FindStatus(GetLoadedLibraries(), "libffi.so"), nullptr);
+
+  Libraries::Init();
+  ASSERT_TRUE(Libraries::IsInitialized());
+  auto &zlib = Libraries::Get<RegistryZlib>();
+  EXPECT_EQ(&zlib, &DlLibSlot<RegistryZlib>::Get());
+  EXPECT_NE(zlib.zlibVersion(), nullptr);
+  Libraries::Init(); // Already constructed, keeps the same wrappers
+  EXPECT_EQ(&Libraries::Get<RegistryZlib>(), &zlib);
+
+  const auto libs = GetLoadedLibraries();
+  const DlLibStatus *z = FindStatus(libs, "libz.so");
+  ASSERT_NE(z, nullptr);
+  EXPECT_EQ(z->loadedLib, "libz.so");
+  EXPECT_TRUE(z->sealed);
+  EXPECT_EQ(z->boundSymbols, 2u);
+  EXPECT_EQ(z->totalSymbols, 2u);
+  const DlLibStatus *ffi = FindStatus(libs, "libffi.so");
+  ASSERT_NE(ffi, nullptr);
+  EXPECT_FALSE(ffi->sealed);
+  EXPECT_EQ(ffi->boundSymbols, 1u);
+  EXPECT_EQ(ffi->totalSymbols, 2u);
+  EXPECT_EQ(ffi->missingSymbols,
+            std::vector<std::string>{"dlutils_ffi_missing"});
+
+  Libraries::Shutdown();
+  EXPECT_FALSE(Libraries::IsInitialized());
+  EXPECT_FALSE(DlLibSlot<RegistryFfi>::IsInitialized());
+  EXPECT_EQ(FindStatus(GetLoadedLibraries(), "libffi.so"), nullptr);
+  EXPECT_FALSE(IsResident("libffi.so"));
+}
+
+TEST(DlLibBaseExtendedTest, RegistryInitRollsBack) {
+  using Libraries = DlLibRegistry<RegistryZlib, RegistryThrows>;
+  EXPECT_THROW(Libraries::Init(), std::runtime_error);
+  EXPECT_FALSE(DlLibSlot<RegistryZlib>::IsInitialized());
+  EXPECT_FALSE(Libraries::IsInitialized());
+}
+
+TEST(DlLibBaseExtendedTest, StatusOfClosedLibrary) {
+  ExtendedMockDlLib lib("libz.so");
+  DlLibStatus status = lib.GetStatus();
+  EXPECT_EQ(status.name, "libz.so");
+  EXPECT_TRUE(status.loadedLib.empty());
+  EXPECT_EQ(status.totalSymbols, 0u);
+}
+
+TEST(DlLibBaseExtendedTest, LoadReportIsOptIn) {
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  DlFun<const char *> zlibVersion;
+  EXPECT_TRUE(lib.LoadSymbol("zlibVersion", zlibVersion));
+  DlLoadReport report = lib.GetLoadReport();
+  EXPECT_TRUE(report.opens.empty());
+  EXPECT_TRUE(report.symbols.empty());
+  EXPECT_EQ(report.dropped, 0u);
+}
+
+TEST(DlLibBaseExtendedTest, LoadReportCapturesDlerror) {
+  ExtendedMockDlLib lib("libdlutils_nonexistent.so");
+  lib.EnableLoadReport();
+  EXPECT_FALSE(lib.OpenLib());
+  ASSERT_EQ(lib.GetLoadReport().opens.size(), 1u);
+  EXPECT_FALSE(lib.GetLoadReport().opens[0].error.empty());
+
+  ExtendedMockDlLib other("libz.so");
+  other.EnableLoadReport();
+  ASSERT_TRUE(other.OpenLib());
+  EXPECT_FALSE(other.AddFallback("libdlutils_nonexistent.so"));
+  const auto opens = other.GetLoadReport().opens;
+  ASSERT_EQ(opens.size(), 2u);
+  EXPECT_EQ(opens[0].lib, "libz.so");
+  EXPECT_TRUE(opens[0].error.empty());
+  EXPECT_EQ(opens[1].lib, "libdlutils_nonexistent.so");
+  EXPECT_NE(opens[1].error.find("libdlutils_nonexistent.so"),
+            std::string::npos);
+}
+
+TEST(DlLibBaseExtendedTest, LoadReportNamesResolvingObject) {
+  ExtendedMockDlLib lib("libz.so");
+  lib.EnableLoadReport();
+  ASSERT_TRUE(lib.OpenLib());
+  DlFun<const char *> zlibVersion;
+  DlFun<int> getpid; // Found in libc, a dependency of libz
+  DlFun<int, int> dlutils_missing_a;
+  DlFun<unsigned long> crc32;
+  EXPECT_TRUE(lib.LoadSymbol("zlibVersion", zlibVersion));
+  EXPECT_TRUE(lib.LoadSymbol("getpid", getpid));
+  EXPECT_FALSE(lib.LoadTable(DLUTILS_SYM_ENTRY(dlutils_missing_a),
+                             DLUTILS_SYM_ENTRY(crc32)));
+
+  DlLoadReport report = lib.GetLoadReport();
+  ASSERT_EQ(report.opens.size(), 1u);
+  ASSERT_EQ(report.symbols.size(), 4u);
+  EXPECT_EQ(report.symbols[0].name, "zlibVersion");
+  EXPECT_NE(report.symbols[0].object.find("libz"), std::string::npos);
+  EXPECT_EQ(report.symbols[1].name, "getpid");
+  EXPECT_NE(report.symbols[1].object.find("libc"), std::string::npos);
+  EXPECT_EQ(report.symbols[2].name, "dlutils_missing_a");
+  EXPECT_TRUE(report.symbols[2].object.empty());
+  EXPECT_NE(report.symbols[2].error.find("dlutils_missing_a"),
+            std::string::npos);
+  EXPECT_EQ(report.symbols[3].name, "crc32");
+  EXPECT_NE(report.symbols[3].object.find("libz"), std::string::npos);
+  EXPECT_TRUE(report.symbols[3].error.empty());
+  EXPECT_EQ(report.dropped, 0u);
+
+  // A lookup answered by the negative cache still reports the dlsym error
+  EXPECT_TRUE(lib.LoadSymbol("dlutils_missing_a", dlutils_missing_a));
+  report = lib.GetLoadReport();
+  ASSERT_EQ(report.symbols.size(), 5u);
+  EXPECT_EQ(report.symbols[4].error, report.symbols[2].error);
+
+  // The report moves with the library
+  ExtendedMockDlLib moved(std::move(lib));
+  EXPECT_EQ(moved.GetLoadReport().symbols.size(), 5u);
+  EXPECT_TRUE(lib.GetLoadReport().symbols.empty());
+}
+
+TEST(DlLibBaseExtendedTest, LoadReportNamesBoundVersion) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  lib.EnableLoadReport();
+  ASSERT_TRUE(lib.OpenLib());
+  DlFun<unsigned long> versioned;
+  DlFun<unsigned long> fallback;
+  DlFun<void> missing;
+  ASSERT_TRUE(lib.LoadVersionedSymbol(
+      "OpenSSL_version_num", {"DLUTILS_MISSING_1.0", "OPENSSL_3.0.0"},
+      versioned));
+  ASSERT_TRUE(lib.LoadVersionedSymbol("OpenSSL_version_num",
+                                      {"DLUTILS_MISSING_1.0"}, fallback));
+  ASSERT_TRUE(lib.LoadVersionedSymbol("dlutils_missing_a",
+                                      {"DLUTILS_MISSING_1.0"}, missing));
+
+  const auto symbols = lib.GetLoadReport().symbols;
+  ASSERT_EQ(symbols.size(), 3u);
+  // The default version was bound, which has no version to name
+  EXPECT_EQ(symbols[1].name, "OpenSSL_version_num");
+  EXPECT_TRUE(symbols[1].error.empty());
+  EXPECT_EQ(symbols[2].name, "dlutils_missing_a");
+  EXPECT_NE(symbols[2].error.find("dlutils_missing_a"), std::string::npos);
+  if (DLUTILS_HAS_DLVSYM) {
+    EXPECT_EQ(symbols[0].name, "OpenSSL_version_num@OPENSSL_3.0.0");
+    EXPECT_NE(symbols[2].error.find("DLUTILS_MISSING_1.0"),
+              std::string::npos);
+  }
+}
+
+TEST(DlLibBaseExtendedTest, LoadReportErrorCoversFallbacks) {
+  ExtendedMockDlLib lib("libz.so");
+  lib.EnableLoadReport();
+  ASSERT_TRUE(lib.OpenLib());
+  ASSERT_TRUE(lib.AddFallback("libffi.so"));
+  DlFun<int, int> dlutils_missing_a;
+  DlFun<void> ffi_call; // Only in the fallback
+  EXPECT_TRUE(lib.LoadSymbol("dlutils_missing_a", dlutils_missing_a));
+  EXPECT_TRUE(lib.LoadSymbol("ffi_call", ffi_call));
+
+  // The error names every object searched, not only the loaded library
+  const auto symbols = lib.GetLoadReport().symbols;
+  ASSERT_EQ(symbols.size(), 2u);
+  EXPECT_NE(symbols[0].error.find("libz"), std::string::npos);
+  EXPECT_NE(symbols[0].error.find("libffi"), std::string::npos);
+  EXPECT_NE(symbols[1].object.find("libffi"), std::string::npos);
+  EXPECT_TRUE(symbols[1].error.empty());
+}
+
+namespace {
+
+using Crc32Fun = DlFun<unsigned long, unsigned long, const unsigned char *,
+                       unsigned int>;
+using Crc32Hook = DlHook<unsigned long, unsigned long, const unsigned char *,
+                         unsigned int>;
+
+} // namespace
+
+TEST(DlLibBaseExtendedTest, HookRunsAroundCalls) {
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  Crc32Fun crc32;
+  ASSERT_TRUE(lib.LoadSymbol("crc32", crc32));
+  const auto direct = crc32.Get();
+  const unsigned char data[] = "dlutils";
+  const unsigned long expected = crc32(0, data, 7);
+
+  std::vector<unsigned int> lengths;
+  unsigned long result = 0;
+  Crc32Hook hook;
+  hook.pre = [&](unsigned long, const unsigned char *, unsigned int len) {
+    lengths.push_back(len);
+  };
+  hook.post = [&](unsigned long r, unsigned long, const unsigned char *,
+                  unsigned int) { result = r; };
+  ASSERT_TRUE(lib.SetHook("crc32", hook));
+  EXPECT_NE(crc32.Get(), direct);
+  EXPECT_EQ(crc32(0, data, 7), expected);
+  EXPECT_EQ(lengths, std::vector<unsigned int>{7});
+  EXPECT_EQ(result, expected);
+
+  // Copies of the hooked DlFun are hooked too
+  Crc32Fun copy = crc32;
+  EXPECT_EQ(copy(0, data, 3), crc32(0, data, 3));
+  EXPECT_EQ(lengths.size(), 3u);
+
+  // Fault injection: the target is not reached
+  hook.pre = [](unsigned long, const unsigned char *, unsigned int) {
+    throw std::runtime_error("injected");
+  };
+  ASSERT_TRUE(lib.SetHook("crc32", hook));
+  EXPECT_THROW(crc32(0, data, 7), std::runtime_error);
+
+  ASSERT_TRUE(lib.RemoveHook("crc32"));
+  EXPECT_EQ(crc32.Get(), direct);
+  EXPECT_EQ(crc32(0, data, 7), expected);
+  EXPECT_FALSE(lib.RemoveHook("crc32"));
+}
+
+TEST(DlLibBaseExtendedTest, HookSamplesCalls) {
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  Crc32Fun crc32;
+  ASSERT_TRUE(lib.LoadTable(DLUTILS_SYM_ENTRY(crc32)));
+
+  int sampled = 0;
+  Crc32Hook hook;
+  hook.pre = [&](unsigned long, const unsigned char *, unsigned int) {
+    sampled++;
+  };
+  hook.sampleEvery = 4;
+  ASSERT_TRUE(lib.SetHook("crc32", hook));
+  for (int i = 0; i < 8; i++) {
+    crc32(0, nullptr, 0);
+  }
+  EXPECT_EQ(sampled, 2);
+  EXPECT_TRUE(lib.RemoveHook("crc32"));
+}
+
+TEST(DlLibBaseExtendedTest, HookSlotsAreGivenBack) {
+  const unsigned char data[] = "dlutils";
+  int calls = 0;
+  Crc32Hook hook;
+  hook.pre = [&](unsigned long, const unsigned char *, unsigned int) {
+    calls++;
+  };
+
+  // More hooks than slots, on distinct functions, one at a time
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  for (size_t i = 0; i < 2 * DLUTILS_HOOK_SLOTS; i++) {
+    Crc32Fun crc32;
+    ASSERT_TRUE(lib.LoadSymbol("crc32", crc32));
+    ASSERT_TRUE(lib.SetHook("crc32", hook)) << i;
+    crc32(0, data, 7);
+    ASSERT_TRUE(lib.RemoveHook("crc32"));
+    ASSERT_TRUE(lib.CloseLib());
+    ASSERT_TRUE(lib.OpenLib());
+  }
+  EXPECT_EQ(calls, 2 * DLUTILS_HOOK_SLOTS);
+
+  // Short-lived wrappers that never remove their hook
+  for (size_t i = 0; i < 2 * DLUTILS_HOOK_SLOTS; i++) {
+    ExtendedMockDlLib scoped("libz.so");
+    ASSERT_TRUE(scoped.OpenLib());
+    Crc32Fun crc32;
+    ASSERT_TRUE(scoped.LoadSymbol("crc32", crc32));
+    ASSERT_TRUE(scoped.SetHook("crc32", hook)) << i;
+  }
+
+  // While every slot is assigned, further functions cannot be hooked
+  std::vector<Crc32Fun> funs(DLUTILS_HOOK_SLOTS + 1);
+  for (auto &fun : funs) {
+    ASSERT_TRUE(lib.LoadSymbol("crc32", fun));
+  }
+  const auto direct = funs[0].Get();
+  EXPECT_TRUE(lib.SetHook("crc32", hook));
+  size_t hooked = 0;
+  for (const auto &fun : funs) {
+    hooked += fun.Get() != direct ? 1 : 0;
+  }
+  EXPECT_EQ(hooked, size_t{DLUTILS_HOOK_SLOTS});
+  EXPECT_TRUE(lib.RemoveHook("crc32"));
+  for (const auto &fun : funs) {
+    EXPECT_EQ(fun.Get(), direct);
+  }
+}
+
+namespace {
+
+// A wrapper owning its function, as wrappers usually do
+class MovableZlib : public DlLibBase {
+public:
+  MovableZlib() : DlLibBase("libz.so") {
+    SelfDlOpen();
+    LoadSymbols();
+  }
+
+  MovableZlib(MovableZlib &&other) = default;
+  MovableZlib &operator=(MovableZlib &&other) = default;
+
+  bool LoadSymbols() { return DLUTILS_SELF_DLSYM(crc32); }
+
+  size_t CacheSize() const { return GetFunCacheSize(); }
+
+  Crc32Fun crc32;
+};
+
+} // namespace
+
+TEST(DlLibBaseExtendedTest, HookAfterMove) {
+  const unsigned char data[] = "dlutils";
+  int calls = 0;
+  Crc32Hook hook;
+  hook.pre = [&](unsigned long, const unsigned char *, unsigned int) {
+    calls++;
+  };
+
+  auto source = std::make_unique<MovableZlib>();
+  const auto direct = source->crc32.Get();
+  ASSERT_TRUE(source->SetHook("crc32", hook));
+  MovableZlib moved(std::move(*source));
+  source.reset();
+
+  // The source was unhooked before its function was copied, and the
+  // bindings of the destroyed source are not used
+  EXPECT_EQ(moved.crc32.Get(), direct);
+  EXPECT_FALSE(moved.SetHook("crc32", hook));
+  EXPECT_FALSE(moved.RemoveHook("crc32"));
+  moved.crc32(0, data, 7);
+  EXPECT_EQ(calls, 0);
+
+  // Once rebound, the function of the new object can be hooked
+  ASSERT_TRUE(moved.LoadSymbols());
+  EXPECT_EQ(moved.CacheSize(), 1u);
+  ASSERT_TRUE(moved.SetHook("crc32", hook));
+  moved.crc32(0, data, 7);
+  EXPECT_EQ(calls, 1);
+
+  // Move assignment unhooks both sides
+  MovableZlib other;
+  ASSERT_TRUE(other.SetHook("crc32", hook));
+  other = std::move(moved);
+  EXPECT_EQ(other.crc32.Get(), direct);
+  other.crc32(0, data, 7);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(DlLibBaseExtendedTest, HookSlotsKeepTheirTarget) {
+  // A signature no other test hooks, so that every slot starts unused
+  using Checksum = DlFun<unsigned long, unsigned long, const void *, unsigned>;
+  using ChecksumHook =
+      DlHook<unsigned long, unsigned long, const void *, unsigned>;
+  const unsigned char data[] = "dlutils";
+  int calls = 0;
+  ChecksumHook hook;
+  hook.pre = [&](unsigned long, const void *, unsigned) { calls++; };
+
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  Checksum crc32;
+  ASSERT_TRUE(lib.LoadSymbol("crc32", crc32));
+  const unsigned long expected = crc32(0, data, 7);
+  ASSERT_TRUE(lib.SetHook("crc32", hook));
+  const Checksum copy = crc32;
+  const auto unchecked = crc32.Unchecked();
+  ASSERT_TRUE(lib.RemoveHook("crc32"));
+
+  // Another target never gets the released slot, even with every other
+  // slot taken, so the copies keep calling crc32
+  std::vector<Checksum> adlers(DLUTILS_HOOK_SLOTS);
+  for (auto &adler : adlers) {
+    ASSERT_TRUE(lib.LoadSymbol("adler32", adler));
+  }
+  const auto adler32 = adlers[0].Get();
+  ASSERT_TRUE(lib.SetHook("adler32", hook));
+  size_t hooked = 0;
+  for (const auto &adler : adlers) {
+    hooked += adler.Get() != adler32 ? 1 : 0;
+  }
+  EXPECT_EQ(hooked, size_t{DLUTILS_HOOK_SLOTS} - 1);
+  calls = 0;
+  EXPECT_EQ(copy(0, data, 7), expected);
+  EXPECT_EQ(unchecked(0, data, 7), expected);
+  EXPECT_EQ(calls, 0);
+
+  // A function rebound to another target leaves its slot to the old one
+  Checksum rebound;
+  ASSERT_TRUE(lib.LoadSymbol("crc32", rebound));
+  ASSERT_TRUE(lib.SetHook("crc32", hook)); // Reuses the crc32 slot
+  const Checksum reboundCopy = rebound;
+  ASSERT_TRUE(lib.LoadSymbol("adler32", rebound));
+  EXPECT_TRUE(lib.SetHook("adler32", hook)); // The other adler32 functions
+  EXPECT_EQ(rebound.Get(), adler32);          // No slot is left for it
+  EXPECT_EQ(reboundCopy(0, data, 7), expected);
+  EXPECT_TRUE(lib.RemoveHook("adler32"));
+}
+
+TEST(DlLibBaseExtendedTest, HookRequiresMatchingBinding) {
+  ExtendedMockDlLib lib("libz.so");
+  ASSERT_TRUE(lib.OpenLib());
+  Crc32Fun crc32;
+  DlFun<int, int> dlutils_missing_a;
+  ASSERT_TRUE(lib.LoadSymbol("crc32", crc32));
+  ASSERT_TRUE(lib.LoadSymbol("dlutils_missing_a", dlutils_missing_a));
+
+  EXPECT_FALSE(lib.SetHook("zlibVersion", Crc32Hook())); // Not bound
+  EXPECT_FALSE(lib.SetHook("crc32", DlHook<int, int>()));  // Wrong type
+  EXPECT_FALSE(lib.SetHook("dlutils_missing_a", DlHook<int, int>()));
+  EXPECT_FALSE(lib.RemoveHook("crc32"));
+
+  // Rebinding the function drops its hook
+  const auto direct = crc32.Get();
+  ASSERT_TRUE(lib.SetHook("crc32", Crc32Hook()));
+  EXPECT_TRUE(lib.ReloadLib([&]() { return lib.LoadSymbol("crc32", crc32); }));
+  EXPECT_EQ(crc32.Get(), direct);
+  EXPECT_FALSE(lib.RemoveHook("crc32"));
+}
+
+TEST(DlLibBaseExtendedTest, CpuFeatures) {
+  EXPECT_TRUE(HasCpuFeatures(DlCpuFeatures::kNone));
+#if defined(__x86_64__)
+  EXPECT_FALSE(HasCpuFeatures(DlCpuFeatures::kNeon));
+  // AVX2 implies AVX on any host
+  if (HasCpuFeatures(DlCpuFeatures::kAvx2)) {
+    EXPECT_TRUE(HasCpuFeatures(DlCpuFeatures::kAvx));
+  }
+#endif
+}
+
+TEST(DlLibBaseExtendedTest, VariantLoadsFirstSupported) {
+  ExtendedMockDlLib lib({
+      {"libcrypto.so", DlCpuFeatures::kNone, [] { return false; }},
+      {"libdlutils_missing_avx2.so", DlCpuFeatures::kAvx2},
+      {"libcrypto.so", DlCpuFeatures::kNone},
+      {"libssl.so", DlCpuFeatures::kNone},
+  });
+  EXPECT_EQ(lib.GetLoadedLib(), "");
+  // The unsupported first variant is skipped, and so is the second one that
+  // cannot be opened (whether or not the host has AVX2)
+  ASSERT_TRUE(lib.OpenLib());
+  EXPECT_EQ(lib.GetLoadedLib(), "libcrypto.so");
+  DlFun<unsigned long> func;
+  ASSERT_TRUE(lib.LoadSymbol("OpenSSL_version_num", func));
+  EXPECT_GT(func(), 0u);
+  EXPECT_TRUE(lib.CloseLib());
+  EXPECT_EQ(lib.GetLoadedLib(), "");
+}
+
+TEST(DlLibBaseExtendedTest, VariantNoneSupported) {
+  ExtendedMockDlLib lib({
+      {"libcrypto.so", DlCpuFeatures::kNone, [] { return false; }},
+  });
+  EXPECT_FALSE(lib.OpenLib());
+  EXPECT_EQ(lib.GetLoadedLib(), "");
+}
+
+TEST(DlLibBaseExtendedTest, SingleLibraryReportsLoadedLib) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+  EXPECT_EQ(lib.GetLoadedLib(), "libcrypto.so");
+}
+
+// Tests for lazily bound functions
+TEST(DlLibBaseExtendedTest, LazySymbolWithNullLibPtr) {
+  ExtendedMockDlLib lib("libnonexistent.so");
+  DlLazyFun<unsigned long> func;
+  EXPECT_FALSE(lib.LoadSymbolLazy("OpenSSL_version_num", func));
+  EXPECT_EQ(func.GetName(), "unknown");
+  EXPECT_EQ(func.Bind(), nullptr);
+  EXPECT_THROW(func(), std::runtime_error);
+}
+
+TEST(DlLibBaseExtendedTest, LazySymbolBindsOnFirstCall) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+
+  DlLazyFun<unsigned long> lazy;
+  ASSERT_TRUE(lib.LoadSymbolLazy("OpenSSL_version_num", lazy));
+  EXPECT_EQ(lazy.GetName(), "OpenSSL_version_num");
+  EXPECT_FALSE(lazy.IsBound());
+  // Lazily bound functions are not resolved into the cache
+  EXPECT_EQ(lib.CacheSize(), 0u);
+
+  DlFun<unsigned long> eager;
+  ASSERT_TRUE(lib.LoadSymbol("OpenSSL_version_num", eager));
+
+  EXPECT_EQ(lazy(), eager());
+  EXPECT_TRUE(lazy.IsBound());
+  EXPECT_EQ(lazy.Get(), eager.Get());
+}
+
+TEST(DlLibBaseExtendedTest, LazySymbolMissing) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+
+  DlLazyFun<int, int> lazy;
+  // Registration succeeds, the failure only shows up when it is resolved
+  ASSERT_TRUE(lib.LoadSymbolLazy("dlutils_nonexistent_function", lazy));
+  EXPECT_EQ(lazy.Bind(), nullptr);
+  EXPECT_FALSE(lazy.IsBound());
+  EXPECT_THROW(lazy(1), std::runtime_error);
+}
+
+// Tests for the process-wide symbol cache shared by DlLibBase instances
+TEST(DlLibBaseExtendedTest, SymbolCacheSharedAcrossInstances) {
+  auto &cache = internal::DlSymbolCache::GetInstance();
+
+  ExtendedMockDlLib first("libcrypto.so");
+  ASSERT_TRUE(first.OpenLib());
+  DlFun<unsigned long> version;
+  ASSERT_TRUE(first.LoadSymbol("OpenSSL_version_num", version));
+
+  void *handle = dlopen("libcrypto.so", RTLD_NOW | RTLD_NOLOAD);
+  ASSERT_NE(handle, nullptr);
+  void *cached = nullptr;
+  EXPECT_TRUE(cache.Lookup(handle, "OpenSSL_version_num", &cached));
+  EXPECT_EQ(cached, reinterpret_cast<void *>(version.Get()));
+
+  // A second instance for the same library gets the cached pointer
+  const size_t size = cache.Size();
+  ExtendedMockDlLib second("libcrypto.so");
+  ASSERT_TRUE(second.OpenLib());
+  DlFun<unsigned long> version2;
+  ASSERT_TRUE(second.LoadSymbol("OpenSSL_version_num", version2));
+  EXPECT_EQ(version2.Get(), version.Get());
+  EXPECT_EQ(cache.Size(), size);
+
+  // Missing symbols are cached as negative entries
+  DlFun<void> missing;
+  ASSERT_TRUE(second.LoadSymbol("dlutils_nonexistent_function", missing));
+  EXPECT_TRUE(cache.Lookup(handle, "dlutils_nonexistent_function", &cached));
+  EXPECT_EQ(cached, nullptr);
+
+  // Closing the library invalidates its cached symbols
+  EXPECT_TRUE(second.CloseLib());
+  EXPECT_FALSE(second.CloseLib());
+  EXPECT_FALSE(cache.Lookup(handle, "OpenSSL_version_num", &cached));
+  dlclose(handle);
+}
+
+TEST(DlLibBaseExtendedTest, SymbolCacheInsertAndInvalidate) {
+  auto &cache = internal::DlSymbolCache::GetInstance();
+  int dummyHandle = 0;
+  int dummySymbol = 0;
+  void *handle = &dummyHandle;
+  void *out = nullptr;
+
+  EXPECT_FALSE(cache.Lookup(handle, "dummy", &out));
+  cache.Insert(handle, "dummy", &dummySymbol);
+  EXPECT_TRUE(cache.Lookup(handle, "dummy", &out));
+  EXPECT_EQ(out, &dummySymbol);
+  // Same name, different handle
+  EXPECT_FALSE(cache.Lookup(&dummySymbol, "dummy", &out));
+
+  cache.Invalidate(handle);
+  EXPECT_FALSE(cache.Lookup(handle, "dummy", &out));
+}
+
+TEST(DlLibBaseExtendedTest, BindingBitsAcrossWords) {
+  internal::DlBindingBits bits;
+  EXPECT_TRUE(bits.AllBound());
+  EXPECT_EQ(bits.BoundCount(), 0u);
+
+  bits.Reserve(130);
+  for (size_t i = 0; i < 128; i++) {
+    bits.Push(true);
+  }
+  EXPECT_TRUE(bits.AllBound()); // Exactly two full words
+  bits.Push(false);
+  bits.Push(true);
+  EXPECT_EQ(bits.Size(), 130u);
+  EXPECT_EQ(bits.BoundCount(), 129u);
+  EXPECT_FALSE(bits.AllBound()); // The miss is in the partial word
+
+  bits.Clear();
+  bits.Push(false);
+  for (size_t i = 0; i < 64; i++) {
+    bits.Push(true);
+  }
+  EXPECT_FALSE(bits.AllBound()); // The miss is in a full word
+  EXPECT_EQ(bits.BoundCount(), 64u);
+
+  // Rebinding overwrites a bit in place
+  bits.Set(0, true);
+  EXPECT_TRUE(bits.Test(0));
+  EXPECT_TRUE(bits.AllBound());
+  bits.Set(64, false);
+  EXPECT_FALSE(bits.Test(64));
+  EXPECT_EQ(bits.Size(), 65u);
+  EXPECT_EQ(bits.BoundCount(), 64u);
+}
+
+// Tests for the dlopen flags
+TEST(DlLibBaseExtendedTest, OpenFlagsToDlOpenMode) {
+  EXPECT_EQ(ToDlOpenMode(DlOpenFlags::kDefault), RTLD_NOW | RTLD_GLOBAL);
+  EXPECT_EQ(ToDlOpenMode(DlOpenFlags::kLazy | DlOpenFlags::kLocal),
+            RTLD_LAZY | RTLD_LOCAL);
+  // kNow wins over kLazy, kGlobal wins over kLocal
+  EXPECT_EQ(ToDlOpenMode(DlOpenFlags::kNow | DlOpenFlags::kLazy |
+                         DlOpenFlags::kGlobal | DlOpenFlags::kLocal),
+            RTLD_NOW | RTLD_GLOBAL);
+  EXPECT_EQ(ToDlOpenMode(DlOpenFlags::kNoDelete | DlOpenFlags::kNoLoad),
+            RTLD_NOW | RTLD_LOCAL | RTLD_NODELETE | RTLD_NOLOAD);
+  EXPECT_TRUE(HasFlag(DlOpenFlags::kDefault, DlOpenFlags::kGlobal));
+  EXPECT_FALSE(HasFlag(DlOpenFlags::kDefault, DlOpenFlags::kLazy));
+}
+
+TEST(DlLibBaseExtendedTest, OpenWithDefaultFlags) {
+  ExtendedMockDlLib lib("libcrypto.so");
+  EXPECT_EQ(lib.GetOpenFlags(), DlOpenFlags::kDefault);
+}
+
+TEST(DlLibBaseExtendedTest, OpenLazyLocal) {
+  ExtendedMockDlLib lib("libcrypto.so",
+                        DlOpenFlags::kLazy | DlOpenFlags::kLocal);
+  EXPECT_EQ(lib.GetOpenFlags(), DlOpenFlags::kLazy | DlOpenFlags::kLocal);
+  ASSERT_TRUE(lib.OpenLib());
+  DlFun<unsigned long> version;
+  ASSERT_TRUE(lib.LoadSymbol("OpenSSL_version_num", version));
+  EXPECT_GT(version(), 0u);
+}
+
+TEST(DlLibBaseExtendedTest, OpenNoLoadProbe) {
+  // RTLD_NOLOAD only succeeds for libraries that are already loaded
+  ExtendedMockDlLib missing("libnonexistent.so", DlOpenFlags::kNoLoad);
+  EXPECT_FALSE(missing.OpenLib());
+
+  ExtendedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+  ExtendedMockDlLib probe("libcrypto.so", DlOpenFlags::kNoLoad);
+  EXPECT_TRUE(probe.OpenLib());
+}
+
+// Mock class loading its functions on a background thread
+class AsyncMockDlLib : public DlLibBase {
+public:
+  explicit AsyncMockDlLib(std::string_view lib) : DlLibBase(lib) {}
+
+  ~AsyncMockDlLib() {
+    // NOTE the loader binds our members, wait for it before they are gone
+    try {
+      WaitLoaded();
+    } catch (...) {
+    }
+  }
+
+  std::shared_future<bool> Preload() {
+    return SelfLoadAsync([this]() {
+      return SelfDlOpen() && SelfDlSymTable(DLUTILS_SYM_ENTRY(EVP_sha256),
+                                            DLUTILS_SYM_ENTRY(EVP_sha1));
+    });
+  }
+
+  template <class Loader> std::shared_future<bool> LoadAsync(Loader loader) {
+    return SelfLoadAsync(std::move(loader));
+  }
+
+  DlFun<const void *> EVP_sha256;
+  DlFun<const void *> EVP_sha1;
+};
+
+TEST(DlLibBaseExtendedTest, AsyncLoadNotStarted) {
+  AsyncMockDlLib lib("libcrypto.so");
+  EXPECT_FALSE(lib.IsLoaded());
+  EXPECT_FALSE(lib.WaitLoaded());
+}
+
+TEST(DlLibBaseExtendedTest, AsyncLoad) {
+  AsyncMockDlLib lib("libcrypto.so");
+  auto future = lib.Preload();
+  EXPECT_TRUE(future.get());
+  EXPECT_TRUE(lib.IsLoaded());
+  EXPECT_TRUE(lib.WaitLoaded());
+  EXPECT_NE(lib.EVP_sha256(), nullptr);
+  EXPECT_NE(lib.EVP_sha1(), nullptr);
+}
+
+TEST(DlLibBaseExtendedTest, AsyncLoadInParallel) {
+  AsyncMockDlLib crypto("libcrypto.so");
+  AsyncMockDlLib missing("libnonexistent.so");
+  auto cryptoFuture = crypto.Preload();
+  auto missingFuture = missing.Preload();
+
+  EXPECT_FALSE(missingFuture.get());
+  EXPECT_FALSE(missing.IsLoaded());
+  EXPECT_TRUE(cryptoFuture.get());
+  EXPECT_TRUE(crypto.IsLoaded());
+}
+
+TEST(DlLibBaseExtendedTest, AsyncLoadPendingIsShared) {
+  AsyncMockDlLib lib("libcrypto.so");
+  std::promise<void> release;
+  auto gate = release.get_future().share();
+  auto first = lib.LoadAsync([gate]() {
+    gate.wait();
+    return true;
+  });
+  // The first load is still pending, so this loader is not run
+  auto second = lib.LoadAsync([]() { return false; });
+  EXPECT_FALSE(lib.IsLoaded());
+  release.set_value();
+  EXPECT_TRUE(second.get());
+  EXPECT_TRUE(first.get());
+  EXPECT_TRUE(lib.IsLoaded());
+}
+
+TEST(DlLibBaseExtendedTest, AsyncLoadException) {
+  AsyncMockDlLib lib("libcrypto.so");
+  auto future = lib.LoadAsync([]() -> bool {
+    throw std::runtime_error("load failed");
+  });
+  EXPECT_THROW(future.get(), std::runtime_error);
+  EXPECT_THROW(lib.WaitLoaded(), std::runtime_error);
+  EXPECT_FALSE(lib.IsLoaded());
+}
+
 TEST(DlLibBaseExtendedTest, ConstructorWithLongLibraryName) {
   std::string longName(1000, 'a');
   longName += ".so";
@@ -20,10 +20,21 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include "dlutils/batch.hpp"
 #include "dlutils/dlutils.hpp"
+#include "dlutils/resource_pool.hpp"
 #include "gtest/gtest.h"
 
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace dlutils {
@@ -92,6 +103,100 @@ TEST(MakeStringTest, WithMixedTypes) {
   EXPECT_EQ(result, "String423.14A");
 }
 
+// The fast path must format exactly like a default std::stringstream
+template <typename... Args> std::string StreamString(const Args &...args) {
+  std::stringstream ss;
+  (ss << ... << args);
+  return ss.str();
+}
+
+TEST(MakeStringTest, MatchesStringStreamForNumbers) {
+  EXPECT_EQ(internal::MakeString(3.14159265), StreamString(3.14159265));
+  EXPECT_EQ(internal::MakeString(1e20), StreamString(1e20));
+  EXPECT_EQ(internal::MakeString(-0.5f), StreamString(-0.5f));
+  EXPECT_EQ(internal::MakeString(-42), StreamString(-42));
+  auto min = std::numeric_limits<int64_t>::min();
+  auto max = std::numeric_limits<uint64_t>::max();
+  EXPECT_EQ(internal::MakeString(min, max), StreamString(min, max));
+  EXPECT_EQ(internal::MakeString(true, false), StreamString(true, false));
+}
+
+TEST(MakeStringTest, MatchesStringStreamForPointers) {
+  int value = 0;
+  int *ptr = &value;
+  EXPECT_EQ(internal::MakeString(ptr), StreamString(ptr));
+  void *null = nullptr;
+  EXPECT_EQ(internal::MakeString(null), "0");
+}
+
+static int StreamedFunction() { return 0; }
+
+TEST(MakeStringTest, StreamsCharAndFunctionPointers) {
+  // operator<< prints these as a string and as bool, not as an address
+  const unsigned char *uchars =
+      reinterpret_cast<const unsigned char *>("abc");
+  const signed char *schars = reinterpret_cast<const signed char *>("def");
+  EXPECT_EQ(internal::MakeString(uchars, schars), "abcdef");
+  EXPECT_EQ(internal::MakeString(uchars), StreamString(uchars));
+
+  int (*fun)() = &StreamedFunction;
+  int (*nullFun)() = nullptr;
+  EXPECT_EQ(internal::MakeString(fun, nullFun), StreamString(fun, nullFun));
+  EXPECT_EQ(internal::MakeString(fun), "1");
+
+  static_assert(!internal::kIsFastFormattable<const unsigned char *>);
+  static_assert(!internal::kIsFastFormattable<int (*)()>);
+#if defined(__SIZEOF_INT128__)
+  static_assert(!internal::kIsFastFormattable<__int128>);
+#endif
+}
+
+TEST(MakeStringTest, WithStringView) {
+  std::string_view sv = "Hello World";
+  EXPECT_EQ(internal::MakeString(sv.substr(0, 5), '!'), "Hello!");
+}
+
+struct Streamable {
+  int value;
+};
+
+std::ostream &operator<<(std::ostream &os, const Streamable &s) {
+  return os << "Streamable(" << s.value << ")";
+}
+
+TEST(MakeStringTest, FallsBackToStringStream) {
+  EXPECT_EQ(internal::MakeString("a ", Streamable{7}, " b"),
+            "a Streamable(7) b");
+  std::stringstream ss;
+  ss << "stream";
+  EXPECT_EQ(internal::MakeString(ss, 1), "stream1");
+}
+
+TEST(MakeStringTest, WithNumberVector) {
+  std::vector<double> vec = {1.5, 2.0, 1e-7};
+  EXPECT_EQ(internal::MakeString(vec, std::string(", ")), "1.5, 2, 1e-07");
+}
+
+TEST(MakeStringTest, WithStreamableVector) {
+  std::vector<Streamable> vec = {{1}, {2}};
+  EXPECT_EQ(internal::MakeString(vec), "Streamable(1) Streamable(2)");
+}
+
+TEST(MakeStringTest, MakeStringToFitsBuffer) {
+  char buf[32];
+  size_t n = internal::MakeStringTo(buf, sizeof(buf), "fn ", 42, " ", 0.25);
+  EXPECT_EQ(std::string(buf, n), "fn 42 0.25");
+  EXPECT_STREQ(buf, "fn 42 0.25");
+}
+
+TEST(MakeStringTest, MakeStringToTruncates) {
+  char buf[8];
+  size_t n = internal::MakeStringTo(buf, sizeof(buf), "abcd", 123456);
+  EXPECT_EQ(n, 7u);
+  EXPECT_STREQ(buf, "abcd123");
+  EXPECT_EQ(internal::MakeStringTo(buf, 0, "abc"), 0u);
+}
+
 } // namespace internal
 
 // Tests for DlFun class
@@ -147,6 +252,347 @@ TEST(DlFunTest, GetFunctionPointerWhenValid) {
   EXPECT_EQ(funcPtr(3, 4), 7);
 }
 
+TEST(DlFunTest, GetReturnsRawFunctionPointer) {
+  using FunTy = DlFun<int, int, int>::FunTy;
+  static_assert(std::is_same_v<decltype(DlFun<int, int, int>().Get()), FunTy>,
+                "Get() should return the raw function pointer type");
+
+  FunTy raw = [](int a, int b) { return a * b; };
+  DlFun<int, int, int> func("mul", raw);
+  EXPECT_EQ(func.Get(), raw);
+  EXPECT_EQ(func(6, 7), raw(6, 7));
+}
+
+TEST(DlFunTest, NoInstrumentationByDefault) {
+  static_assert(!DLUTILS_ENABLE_INSTRUMENTATION,
+                "dlutils_test is built without instrumentation");
+  // Compiled out instrumentation adds nothing to DlFun
+  static_assert(sizeof(DlFun<int, int, int>) == 2 * sizeof(void *),
+                "DlFun should only hold its name and pointer");
+  static_assert(sizeof(DlLazyFun<int, int, int>) == 3 * sizeof(void *),
+                "DlLazyFun should only hold its owner, name and pointer");
+}
+
+TEST(DlFunTest, BatchWithNullptr) {
+  DlFun<int, int, int> func;
+  EXPECT_THROW(func.Batch(), std::runtime_error);
+}
+
+TEST(DlFunTest, BatchOverTuples) {
+  auto lambda = [](int a, int b) { return a * b; };
+  DlFun<int, int, int> func("mul", lambda);
+  std::vector<std::tuple<int, int>> args;
+  for (int i = 0; i < 100; i++) {
+    args.emplace_back(i, i + 1);
+  }
+  std::vector<int> results(args.size());
+  func.Batch()(args.data(), args.size(), results.data());
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(results[i], i * (i + 1));
+  }
+  // Results may be discarded
+  func.Batch()(args.data(), args.size());
+}
+
+TEST(DlFunTest, BatchOverColumns) {
+  auto lambda = [](const int *value, int scale) { return *value * scale; };
+  DlFun<int, const int *, int> func("scale", lambda);
+  std::vector<int> values = {1, 2, 3, 4, 5, 6, 7, 8};
+  std::vector<const int *> ptrs;
+  std::vector<int> scales;
+  for (size_t i = 0; i < values.size(); i++) {
+    ptrs.push_back(&values[i]);
+    scales.push_back(static_cast<int>(i));
+  }
+  std::vector<int> results(values.size());
+  auto batch = func.Batch();
+  batch.SetPrefetch(2).CallColumns(values.size(), results.data(), ptrs.data(),
+                                   scales.data());
+  for (size_t i = 0; i < values.size(); i++) {
+    EXPECT_EQ(results[i], values[i] * static_cast<int>(i));
+  }
+}
+
+int g_batchSum = 0;
+
+TEST(DlFunTest, BatchVoidFunction) {
+  auto lambda = [](int a) { g_batchSum += a; };
+  DlFun<void, int> func("accumulate", lambda);
+  std::vector<std::tuple<int>> args = {{1}, {2}, {3}};
+  g_batchSum = 0;
+  func.Batch()(args.data(), args.size());
+  EXPECT_EQ(g_batchSum, 6);
+}
+
+TEST(DlFunTest, BatchParallel) {
+  auto lambda = [](int a, int b) { return a + b; };
+  DlFun<int, int, int> func("add", lambda);
+  std::vector<std::tuple<int, int>> args;
+  for (int i = 0; i < 10000; i++) {
+    args.emplace_back(i, 2 * i);
+  }
+  std::vector<int> results(args.size());
+  DlThreadPool pool(3);
+  EXPECT_EQ(pool.Size(), 3u);
+  func.Batch().Parallel(pool, args.data(), args.size(), results.data(), 64);
+  for (int i = 0; i < 10000; i++) {
+    ASSERT_EQ(results[i], 3 * i);
+  }
+}
+
+TEST(DlFunTest, ThreadPoolRethrows) {
+  DlThreadPool pool(2);
+  std::atomic<size_t> calls{0};
+  EXPECT_THROW(pool.ParallelFor(100, 10,
+                                [&calls](size_t begin, size_t) {
+                                  calls++;
+                                  if (begin == 50) {
+                                    throw std::runtime_error("chunk failed");
+                                  }
+                                }),
+               std::runtime_error);
+  // The other chunks still ran
+  EXPECT_EQ(calls.load(), 10u);
+  // A pool without workers runs the loop on the caller
+  DlThreadPool inline_pool(0);
+  size_t covered = 0;
+  inline_pool.ParallelFor(100, 10, [&covered](size_t begin, size_t end) {
+    covered += end - begin;
+  });
+  EXPECT_EQ(covered, 100u);
+}
+
+TEST(DlFunTest, IsTriviallyCopyable) {
+  static_assert(std::is_trivially_copyable_v<DlFun<int, int, int>>,
+                "DlFun should be trivially copyable");
+  auto lambda = [](int a, int b) { return a + b; };
+  DlFun<int, int, int> func("add", lambda);
+  DlFun<int, int, int> copy = func;
+  EXPECT_EQ(copy.GetName(), "add");
+  EXPECT_EQ(copy(2, 3), 5);
+}
+
+TEST(DlFunTest, NamesAreInterned) {
+  auto lambda = [](int a, int b) { return a + b; };
+  std::string name = "add";
+  DlFun<int, int, int> a(name, lambda);
+  name = "changed";
+  DlFun<int, int, int> b("add", lambda);
+  // The name outlives the string it was built from and is shared
+  EXPECT_EQ(a.GetName(), "add");
+  EXPECT_EQ(a.GetName().data(), b.GetName().data());
+  EXPECT_EQ(a.GetName().data()[a.GetName().size()], '\0');
+}
+
+// The call operators forward their arguments: the target sees the copies and
+// moves of a perfectly forwarded call, and no more
+namespace {
+
+struct Counted {
+  static inline int copies = 0;
+  static inline int moves = 0;
+
+  Counted() = default;
+  Counted(const Counted &) { copies++; }
+  Counted(Counted &&) noexcept { moves++; }
+
+  static void Reset() { copies = moves = 0; }
+};
+
+int TakeValue(Counted) { return 1; }
+int TakeRef(const Counted &) { return 2; }
+
+// Calls fn with an lvalue and an rvalue, returns the (copies, moves) made
+template <class Fn> std::pair<int, int> CountCopies(const Fn &fn) {
+  Counted c;
+  Counted::Reset();
+  fn(c);
+  fn(Counted());
+  return {Counted::copies, Counted::moves};
+}
+
+} // namespace
+
+TEST(DlFunTest, CallIsConstAndConstrained) {
+  using Fun = DlFun<int, int, int>;
+  static_assert(std::is_invocable_r_v<int, const Fun &, int, int>);
+  static_assert(std::is_invocable_r_v<int, const Fun &, short, long>);
+  static_assert(!std::is_invocable_v<const Fun &, int>);
+  static_assert(!std::is_invocable_v<const Fun &, const char *, int>);
+  using Unchecked = DlUncheckedFun<int, int, int>;
+  static_assert(std::is_invocable_r_v<int, const Unchecked &, int, int>);
+  static_assert(std::is_trivially_copyable_v<Unchecked>);
+  static_assert(sizeof(Unchecked) == sizeof(int (*)(int, int)));
+  // noexcept follows the target: a plain C function pointer is not noexcept
+  static_assert(std::is_nothrow_invocable_v<const Unchecked &, int, int> ==
+                std::is_nothrow_invocable_v<int (*)(int, int), int, int>);
+  static_assert(std::is_invocable_v<const DlLazyFun<void> &>);
+
+  const Fun func("add", [](int a, int b) { return a + b; });
+  EXPECT_EQ(func(2, 3), 5);
+  EXPECT_EQ(func.Unchecked()(2, 3), 5);
+}
+
+TEST(DlFunTest, CallForwardsArguments) {
+  auto forward = [](auto fun) {
+    return [fun](auto &&arg) {
+      return fun(std::forward<decltype(arg)>(arg));
+    };
+  };
+  // An lvalue is copied once; a temporary is moved once, as by std::invoke
+  const auto directValue = CountCopies(forward(&TakeValue));
+  const auto directRef = CountCopies(forward(&TakeRef));
+  EXPECT_EQ(directValue, std::make_pair(1, 1));
+  EXPECT_EQ(directRef, std::make_pair(0, 0));
+
+  const DlFun<int, Counted> byValue("take_value", TakeValue);
+  const DlFun<int, const Counted &> byRef("take_ref", TakeRef);
+  EXPECT_EQ(CountCopies(byValue), directValue);
+  EXPECT_EQ(CountCopies(byRef), directRef);
+  EXPECT_EQ(CountCopies(byValue.Unchecked()), directValue);
+  EXPECT_EQ(CountCopies(byRef.Unchecked()), directRef);
+}
+
+TEST(DlFunTest, UncheckedWithValidFunction) {
+  auto lambda = [](int a, int b) { return a + b; };
+  DlFun<int, int, int> func("add", lambda);
+  auto unchecked = func.Unchecked();
+  EXPECT_EQ(unchecked.Get(), func.Get());
+  EXPECT_EQ(unchecked(3, 4), 7);
+}
+
+TEST(DlFunTest, UncheckedWithNullptr) {
+  DlFun<int, int, int> func;
+  EXPECT_THROW(func.Unchecked(), std::runtime_error);
+}
+
+TEST(DlFunTest, ErrorMessageContainsFunctionName) {
+  DlFun<int, int, int> func("missing_function", nullptr);
+  try {
+    func(1, 2);
+    FAIL() << "Expected std::runtime_error";
+  } catch (const std::runtime_error &e) {
+    EXPECT_NE(std::string(e.what()).find("missing_function"),
+              std::string::npos);
+  }
+}
+
+// Tests for DlResourcePool, over a create/free pair of plain functions
+namespace {
+
+std::atomic<int> gLiveResources{0};
+
+int *CreateResource() {
+  gLiveResources++;
+  return new int(0);
+}
+
+void FreeResource(int *res) {
+  gLiveResources--;
+  delete res;
+}
+
+} // namespace
+
+TEST(DlResourcePoolTest, ReusesReleasedResources) {
+  DlFun<int *> create("create", CreateResource);
+  DlFun<void, int *> destroy("destroy", FreeResource);
+  {
+    DlResourcePool<int> pool(create, destroy);
+    pool.SetReset([](int *res) { *res = 0; });
+    int *first = nullptr;
+    {
+      auto res = pool.Acquire();
+      first = res.Get();
+      *first = 42;
+    }
+    EXPECT_EQ(pool.LocalFreeCount(), 1u);
+    auto res = pool.Acquire();
+    EXPECT_EQ(res.Get(), first);
+    EXPECT_EQ(*res.Get(), 0); // Reset on release
+    EXPECT_EQ(pool.LocalFreeCount(), 0u);
+    EXPECT_EQ(gLiveResources.load(), 1);
+  }
+  EXPECT_EQ(gLiveResources.load(), 0);
+}
+
+TEST(DlResourcePoolTest, FreesBeyondTheLimit) {
+  DlFun<int *> create("create", CreateResource);
+  DlFun<void, int *> destroy("destroy", FreeResource);
+  DlResourcePool<int> pool(create, destroy, 2);
+  {
+    std::vector<DlResourcePool<int>::Handle> leased;
+    for (int i = 0; i < 4; i++) {
+      leased.push_back(pool.Acquire());
+    }
+    EXPECT_EQ(gLiveResources.load(), 4);
+  }
+  EXPECT_EQ(pool.LocalFreeCount(), 2u);
+  EXPECT_EQ(gLiveResources.load(), 2);
+  pool.Clear();
+  EXPECT_EQ(pool.LocalFreeCount(), 0u);
+  EXPECT_EQ(gLiveResources.load(), 0);
+}
+
+TEST(DlResourcePoolTest, PerThreadFreeLists) {
+  DlFun<int *> create("create", CreateResource);
+  DlFun<void, int *> destroy("destroy", FreeResource);
+  DlResourcePool<int> pool(create, destroy);
+  pool.Acquire();
+  std::thread worker([&pool]() {
+    EXPECT_EQ(pool.LocalFreeCount(), 0u);
+    pool.Acquire();
+    EXPECT_EQ(pool.LocalFreeCount(), 1u);
+  });
+  worker.join();
+  // The worker's resource was freed when it exited
+  EXPECT_EQ(pool.LocalFreeCount(), 1u);
+  EXPECT_EQ(gLiveResources.load(), 1);
+  pool.Clear();
+  EXPECT_EQ(gLiveResources.load(), 0);
+}
+
+TEST(DlResourcePoolTest, ForgetsExitedThreads) {
+  DlFun<int *> create("create", CreateResource);
+  DlFun<void, int *> destroy("destroy", FreeResource);
+  DlResourcePool<int> pool(create, destroy);
+  pool.Acquire();
+  for (int i = 0; i < 32; i++) {
+    std::thread([&pool]() { pool.Acquire(); }).join();
+  }
+  EXPECT_EQ(pool.ThreadCount(), 1u);
+  EXPECT_EQ(gLiveResources.load(), 1);
+
+  // A thread that outlives a Clear() registers again
+  pool.Clear();
+  EXPECT_EQ(pool.ThreadCount(), 0u);
+  pool.Acquire();
+  EXPECT_EQ(pool.ThreadCount(), 1u);
+}
+
+TEST(DlResourcePoolTest, DropsFreeListsOfDestroyedPools) {
+  DlFun<int *> create("create", CreateResource);
+  DlFun<void, int *> destroy("destroy", FreeResource);
+  DlResourcePool<int> kept(create, destroy);
+  kept.Acquire();
+  const size_t base = DlResourcePool<int>::LocalShardCount();
+  for (int i = 0; i < 32; i++) {
+    DlResourcePool<int> pool(create, destroy);
+    pool.Acquire();
+    kept.Acquire(); // Alternate with a live pool
+    EXPECT_LE(DlResourcePool<int>::LocalShardCount(), base + 1);
+  }
+  EXPECT_EQ(kept.LocalFreeCount(), 1u);
+  EXPECT_EQ(gLiveResources.load(), 1);
+}
+
+TEST(DlResourcePoolTest, ThrowsWhenCreationFails) {
+  DlFun<int *> create("create_nothing", []() -> int * { return nullptr; });
+  DlFun<void, int *> destroy("destroy", FreeResource);
+  DlResourcePool<int> pool(create, destroy);
+  EXPECT_THROW(pool.Acquire(), std::runtime_error);
+}
+
 // Remove complex function tests for now to avoid compilation issues
 
 // Mock class for testing DlLibBase
@@ -163,6 +609,8 @@ public:
 
   bool CheckCache() { return CheckFunCache(); }
 
+  bool SealLib() { return Seal(); }
+
   size_t CacheSize() { return GetFunCacheSize(); }
 };
 
@@ -178,6 +626,23 @@ TEST(DlLibBaseTest, GetFunCacheSizeInitiallyZero) {
   EXPECT_EQ(lib.CacheSize(), 0u);
 }
 
+TEST(DlLibBaseTest, NoCallStatsWithoutInstrumentation) {
+  MockDlLib lib("libtest.so");
+  EXPECT_TRUE(lib.GetCallStats().empty());
+}
+
+TEST(DlLibBaseTest, NotSealedInitially) {
+  MockDlLib lib("libtest.so");
+  EXPECT_FALSE(lib.IsSealed());
+}
+
+TEST(DlLibBaseTest, SealWithEmptyCache) {
+  MockDlLib lib("libtest.so");
+  // Nothing was loaded, so there is nothing that could be missing
+  EXPECT_TRUE(lib.SealLib());
+  EXPECT_TRUE(lib.IsSealed());
+}
+
 TEST(DlLibBaseTest, CheckFunCacheInitiallyTrue) {
   MockDlLib lib("libtest.so");
   // Initially no functions loaded, so should return true
@@ -0,0 +1,166 @@
+// MIT License
+//
+// Copyright (c) 2025 Jamie Cui
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// NOTE this file is compiled with DLUTILS_ENABLE_INSTRUMENTATION=1
+#include "dlutils/dlutils.hpp"
+#include "gtest/gtest.h"
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+static_assert(DLUTILS_ENABLE_INSTRUMENTATION,
+              "instrument_test must be built with instrumentation enabled");
+
+namespace dlutils {
+
+// Mock class for testing the instrumented DlLibBase
+class InstrumentedMockDlLib : public DlLibBase {
+public:
+  explicit InstrumentedMockDlLib(std::string_view lib) : DlLibBase(lib) {}
+
+  bool OpenLib() { return SelfDlOpen(); }
+
+  template <class R, class... Args>
+  bool LoadSymbol(std::string_view funName, DlFun<R, Args...> &outFun) {
+    return SelfDlSym(funName, outFun);
+  }
+
+  template <class R, class... Args>
+  bool LoadSymbolLazy(std::string_view funName, DlLazyFun<R, Args...> &outFun) {
+    return SelfDlSymLazy(funName, outFun);
+  }
+};
+
+static uint64_t HistogramTotal(const DlCallStats &stats) {
+  return std::accumulate(stats.latencyNs.begin(), stats.latencyNs.end(),
+                         uint64_t{0});
+}
+
+TEST(InstrumentTest, NoStatsInitially) {
+  InstrumentedMockDlLib lib("libcrypto.so");
+  EXPECT_TRUE(lib.GetCallStats().empty());
+}
+
+TEST(InstrumentTest, UnownedDlFunIsNotRecorded) {
+  auto lambda = [](int a, int b) { return a + b; };
+  DlFun<int, int, int> func("add", lambda);
+  EXPECT_EQ(func(3, 4), 7);
+}
+
+TEST(InstrumentTest, CountsCallsPerSymbol) {
+  InstrumentedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+
+  DlFun<unsigned long> version;
+  DlLazyFun<const void *> sha256;
+  ASSERT_TRUE(lib.LoadSymbol("OpenSSL_version_num", version));
+  ASSERT_TRUE(lib.LoadSymbolLazy("EVP_sha256", sha256));
+
+  for (int i = 0; i < 100; i++) {
+    version();
+  }
+  for (int i = 0; i < 10; i++) {
+    sha256();
+  }
+
+  auto stats = lib.GetCallStats();
+  ASSERT_EQ(stats.size(), 2u);
+  EXPECT_EQ(stats[0].name, "OpenSSL_version_num");
+  EXPECT_EQ(stats[0].calls, 100u);
+  EXPECT_EQ(HistogramTotal(stats[0]), 100u);
+  EXPECT_EQ(stats[1].name, "EVP_sha256");
+  EXPECT_EQ(stats[1].calls, 10u);
+  EXPECT_EQ(HistogramTotal(stats[1]), 10u);
+
+  lib.ResetCallStats();
+  stats = lib.GetCallStats();
+  ASSERT_EQ(stats.size(), 2u);
+  EXPECT_EQ(stats[0].calls, 0u);
+  EXPECT_EQ(stats[0].totalNs, 0u);
+  EXPECT_EQ(HistogramTotal(stats[0]), 0u);
+}
+
+TEST(InstrumentTest, RebindingKeepsCounters) {
+  InstrumentedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+
+  DlFun<unsigned long> version;
+  ASSERT_TRUE(lib.LoadSymbol("OpenSSL_version_num", version));
+  version();
+  ASSERT_TRUE(lib.LoadSymbol("OpenSSL_version_num", version));
+  version();
+
+  auto stats = lib.GetCallStats();
+  ASSERT_EQ(stats.size(), 1u);
+  EXPECT_EQ(stats[0].calls, 2u);
+}
+
+TEST(InstrumentTest, AggregatesThreadShards) {
+  InstrumentedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+
+  DlFun<unsigned long> version;
+  ASSERT_TRUE(lib.LoadSymbol("OpenSSL_version_num", version));
+
+  constexpr int kThreads = 12;
+  constexpr int kCalls = 1000;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < kThreads; t++) {
+    workers.emplace_back([&version]() {
+      for (int i = 0; i < kCalls; i++) {
+        version();
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  auto stats = lib.GetCallStats();
+  ASSERT_EQ(stats.size(), 1u);
+  EXPECT_EQ(stats[0].calls, uint64_t{kThreads * kCalls});
+  EXPECT_EQ(HistogramTotal(stats[0]), uint64_t{kThreads * kCalls});
+}
+
+TEST(InstrumentTest, ResetKeepsCountsOfLaterCalls) {
+  InstrumentedMockDlLib lib("libcrypto.so");
+  ASSERT_TRUE(lib.OpenLib());
+
+  DlFun<unsigned long> version;
+  ASSERT_TRUE(lib.LoadSymbol("OpenSSL_version_num", version));
+  for (int i = 0; i < 10; i++) {
+    version();
+  }
+  std::thread([&version]() { version(); }).join();
+  lib.ResetCallStats();
+
+  // Both the exited thread's shard and the caller's shard count from zero
+  std::thread([&version]() { version(); }).join();
+  version();
+  auto stats = lib.GetCallStats();
+  ASSERT_EQ(stats.size(), 1u);
+  EXPECT_EQ(stats[0].calls, 2u);
+  EXPECT_EQ(HistogramTotal(stats[0]), 2u);
+}
+
+} // namespace dlutils
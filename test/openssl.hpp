@@ -25,6 +25,8 @@
 #include <dlfcn.h>
 
 #include "dlutils/dlutils.hpp"
+#include "dlutils/registry.hpp"
+#include "dlutils/resource_pool.hpp"
 
 namespace dlutils {
 
@@ -48,10 +50,29 @@ public:
   // Check wheter dlopen and dlsym has succeed
   bool CheckOk() { return CheckFunCache(); }
 
-  // Reload all functions
+  // Hot-reload the library, and seal it again if all functions loaded. The
+  // old handle is closed once the calls made under a ReadGuard are done
   bool Reload() {
-    LoadAll();
-    return CheckFunCache();
+    return SelfDlReload([this]() {
+      LoadSymbols();
+      return Seal();
+    });
+  }
+
+  // Hot-reload the library, binding one function at a time: the reload still
+  // publishes them all as one set
+  bool ReloadEach() {
+    return SelfDlReload([this]() {
+      DLUTILS_SELF_DLSYM(EVP_MD_CTX_new);
+      DLUTILS_SELF_DLSYM(EVP_sha256);
+      DLUTILS_SELF_DLSYM(EVP_sha1);
+      DLUTILS_SELF_DLSYM(EVP_DigestInit_ex);
+      DLUTILS_SELF_DLSYM(EVP_DigestUpdate);
+      DLUTILS_SELF_DLSYM(EVP_DigestFinal_ex);
+      DLUTILS_SELF_DLSYM(EVP_MD_CTX_free);
+      DLUTILS_SELF_DLSYM(EVP_MD_CTX_reset);
+      return Seal();
+    });
   }
 
   // Size() function will not check if all functions are callable
@@ -67,23 +88,66 @@ public:
   DlFun<int, EVP_MD_CTX *, const void *, size_t> EVP_DigestUpdate;
   DlFun<int, EVP_MD_CTX *, unsigned char *, unsigned int *> EVP_DigestFinal_ex;
   DlFun<void, EVP_MD_CTX *> EVP_MD_CTX_free;
+  DlFun<int, EVP_MD_CTX *> EVP_MD_CTX_reset;
+
+  // Digest contexts reused per thread: Acquire() one instead of calling
+  // EVP_MD_CTX_new, it goes back to the pool (reset) when the handle dies
+  DlResourcePool<EVP_MD_CTX> MdCtxPool{EVP_MD_CTX_new, EVP_MD_CTX_free};
 
 private:
+  // NOTE allow a DlLibRegistry to construct it without GetInstance()
+  friend class DlLibSlot<LibCrypto>;
+
   void LoadAll() {
     // NOTE explicitly dlopen shared library
     SelfDlOpen();
-    DLUTILS_SELF_DLSYM(EVP_MD_CTX_new);
-    DLUTILS_SELF_DLSYM(EVP_sha256);
-    DLUTILS_SELF_DLSYM(EVP_sha1);
-    DLUTILS_SELF_DLSYM(EVP_DigestInit_ex);
-    DLUTILS_SELF_DLSYM(EVP_DigestUpdate);
-    DLUTILS_SELF_DLSYM(EVP_DigestFinal_ex);
-    DLUTILS_SELF_DLSYM(EVP_MD_CTX_free);
+    LoadSymbols();
   }
 
-  LibCrypto() : DlLibBase(LIB_NAME) { LoadAll(); }
+  void LoadSymbols() {
+    // NOTE resolve all functions in a single pass
+    SelfDlSymTable(DLUTILS_SYM_ENTRY(EVP_MD_CTX_new),
+                   DLUTILS_SYM_ENTRY(EVP_sha256),
+                   DLUTILS_SYM_ENTRY(EVP_sha1),
+                   DLUTILS_SYM_ENTRY(EVP_DigestInit_ex),
+                   DLUTILS_SYM_ENTRY(EVP_DigestUpdate),
+                   DLUTILS_SYM_ENTRY(EVP_DigestFinal_ex),
+                   DLUTILS_SYM_ENTRY(EVP_MD_CTX_free),
+                   DLUTILS_SYM_ENTRY(EVP_MD_CTX_reset));
+  }
+
+  LibCrypto() : DlLibBase(LIB_NAME) {
+    LoadAll();
+    Seal();
+    MdCtxPool.SetReset([this](EVP_MD_CTX *ctx) { EVP_MD_CTX_reset(ctx); });
+  }
 
   static constexpr std::string_view LIB_NAME = "libcrypto.so";
 };
 
+// The same functions, declared once: the X-macro list below generates the
+// dense pointer table, the names and the call wrappers
+#define LIBCRYPTO_SYMBOLS(X)                                                   \
+  X(EVP_MD_CTX_new, EVP_MD_CTX *, ())                                          \
+  X(EVP_sha256, const EVP_MD *, ())                                            \
+  X(EVP_sha1, const EVP_MD *, ())                                              \
+  X(EVP_DigestInit_ex, int, (EVP_MD_CTX *, const EVP_MD *, ENGINE *))          \
+  X(EVP_DigestUpdate, int, (EVP_MD_CTX *, const void *, size_t))               \
+  X(EVP_DigestFinal_ex, int, (EVP_MD_CTX *, unsigned char *, unsigned int *))  \
+  X(EVP_MD_CTX_free, void, (EVP_MD_CTX *))
+
+DLUTILS_DEFINE_SYMBOL_TABLE(LibCryptoSymbols, LIBCRYPTO_SYMBOLS);
+
+class LibCryptoTable : public DlLibBase, public LibCryptoSymbols {
+public:
+  LibCryptoTable() : DlLibBase("libcrypto.so") {
+    SelfDlOpen();
+    SelfDlLoadTable(*this);
+    Seal();
+  }
+
+  // Check wheter dlopen and dlsym has succeed
+  bool CheckOk() { return CheckFunCache(); }
+};
+
 } // namespace dlutils
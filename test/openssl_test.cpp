@@ -21,14 +21,20 @@
 // SOFTWARE.
 
 #include "openssl.hpp"
+#include "dlutils/batch.hpp"
 #include "gtest/gtest.h"
+#include <atomic>
 #include <cstdio>
 #include <cstring>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 namespace dlutils {
 
 TEST(OpenSSLTest, ShouldWork) {
-  auto libcrypto = LibCrypto::GetInstance();
+  auto &libcrypto = LibCrypto::GetInstance();
   EVP_MD_CTX *mdctx;
   const EVP_MD *md;
   unsigned char md_value[EVP_MAX_MD_SIZE];
@@ -71,7 +77,7 @@ TEST(OpenSSLTest, ShouldWork) {
 
 // Additional test using SHA1 hash function
 TEST(OpenSSLTest, ShouldWorkWithSHA1) {
-  auto libcrypto = LibCrypto::GetInstance();
+  auto &libcrypto = LibCrypto::GetInstance();
   EVP_MD_CTX *mdctx;
   const EVP_MD *md;
   unsigned char md_value[EVP_MAX_MD_SIZE];
@@ -112,9 +118,73 @@ TEST(OpenSSLTest, ShouldWorkWithSHA1) {
   printf("\n");
 }
 
+// Hashing many small buffers with one batched call
+TEST(OpenSSLTest, BatchedDigestUpdate) {
+  auto &libcrypto = LibCrypto::GetInstance();
+  std::vector<std::string> chunks;
+  std::string whole;
+  for (int i = 0; i < 256; i++) {
+    chunks.push_back("chunk-" + std::to_string(i));
+    whole += chunks.back();
+  }
+
+  auto digest = [&libcrypto](auto update) {
+    unsigned char md_value[EVP_MAX_MD_SIZE];
+    unsigned int md_len = 0;
+    EVP_MD_CTX *mdctx = libcrypto.EVP_MD_CTX_new();
+    libcrypto.EVP_DigestInit_ex(mdctx, libcrypto.EVP_sha256(), nullptr);
+    update(mdctx);
+    libcrypto.EVP_DigestFinal_ex(mdctx, md_value, &md_len);
+    libcrypto.EVP_MD_CTX_free(mdctx);
+    return std::string(reinterpret_cast<char *>(md_value), md_len);
+  };
+
+  const std::string expected = digest([&](EVP_MD_CTX *mdctx) {
+    libcrypto.EVP_DigestUpdate(mdctx, whole.data(), whole.size());
+  });
+  const std::string batched = digest([&](EVP_MD_CTX *mdctx) {
+    std::vector<std::tuple<EVP_MD_CTX *, const void *, size_t>> args;
+    for (const auto &chunk : chunks) {
+      args.emplace_back(mdctx, chunk.data(), chunk.size());
+    }
+    std::vector<int> results(args.size());
+    libcrypto.EVP_DigestUpdate.Batch().SetPrefetch(4)(
+        args.data(), args.size(), results.data());
+    for (int result : results) {
+      EXPECT_EQ(result, 1);
+    }
+  });
+  EXPECT_EQ(batched, expected);
+}
+
+// The generated symbol table is called like the DlFun members
+TEST(OpenSSLTest, ShouldWorkWithSymbolTable) {
+  LibCryptoTable libcrypto;
+  ASSERT_TRUE(libcrypto.CheckOk());
+  ASSERT_TRUE(libcrypto.IsSealed());
+  unsigned char md_value[EVP_MAX_MD_SIZE];
+  unsigned int md_len;
+  const char *message = "Hello, OpenSSL Hashing!";
+
+  EVP_MD_CTX *mdctx = libcrypto.EVP_MD_CTX_new();
+  ASSERT_NE(mdctx, nullptr) << "Error creating EVP_MD_CTX";
+  ASSERT_EQ(libcrypto.EVP_DigestInit_ex(mdctx, libcrypto.EVP_sha256(), nullptr),
+            1);
+  ASSERT_EQ(libcrypto.EVP_DigestUpdate(mdctx, message, strlen(message)), 1);
+  ASSERT_EQ(libcrypto.EVP_DigestFinal_ex(mdctx, md_value, &md_len), 1);
+  libcrypto.EVP_MD_CTX_free(mdctx);
+  EXPECT_EQ(md_len, 32u);
+
+  // The pointers are the ones the DlFun members resolved
+  auto &reference = LibCrypto::GetInstance();
+  EXPECT_EQ(libcrypto.slots.Get<int(EVP_MD_CTX *, const void *, size_t)>(
+                LibCryptoSymbols::kEVP_DigestUpdate),
+            reference.EVP_DigestUpdate.Get());
+}
+
 // Test to verify library loading status functions
 TEST(OpenSSLTest, LibraryStatus) {
-  auto libcrypto = LibCrypto::GetInstance();
+  auto &libcrypto = LibCrypto::GetInstance();
   
   // Test Size() function
   EXPECT_GT(libcrypto.Size(), 0u);
@@ -127,6 +197,143 @@ TEST(OpenSSLTest, LibraryStatus) {
   EXPECT_TRUE(libcrypto.CheckOk());
 }
 
+// Test the unchecked call wrappers handed out by a sealed library
+TEST(OpenSSLTest, ShouldWorkUnchecked) {
+  auto &libcrypto = LibCrypto::GetInstance();
+  ASSERT_TRUE(libcrypto.IsSealed());
+
+  auto ctx_new = libcrypto.EVP_MD_CTX_new.Unchecked();
+  auto digest_init = libcrypto.EVP_DigestInit_ex.Unchecked();
+  auto digest_update = libcrypto.EVP_DigestUpdate.Unchecked();
+  auto digest_final = libcrypto.EVP_DigestFinal_ex.Unchecked();
+  auto ctx_free = libcrypto.EVP_MD_CTX_free.Unchecked();
+
+  unsigned char md_value[EVP_MAX_MD_SIZE];
+  unsigned int md_len;
+  const char *message = "Hello, OpenSSL Hashing!";
+
+  EVP_MD_CTX *mdctx = ctx_new();
+  ASSERT_NE(mdctx, nullptr) << "Error creating EVP_MD_CTX";
+  ASSERT_EQ(digest_init(mdctx, libcrypto.EVP_sha256(), nullptr), 1);
+  for (int i = 0; i < 16; i++) {
+    ASSERT_EQ(digest_update(mdctx, message, strlen(message)), 1);
+  }
+  ASSERT_EQ(digest_final(mdctx, md_value, &md_len), 1);
+  ctx_free(mdctx);
+
+  EXPECT_EQ(md_len, 32u);
+}
+
+// Test that reloading while other threads hash does not disturb them
+TEST(OpenSSLTest, ConcurrentReload) {
+  auto &libcrypto = LibCrypto::GetInstance();
+  const char *message = "Hello, OpenSSL Hashing!";
+
+  auto sha256 = [&libcrypto, message]() {
+    unsigned char md_value[EVP_MAX_MD_SIZE];
+    unsigned int md_len = 0;
+    DlLibBase::ReadGuard guard(libcrypto);
+    EVP_MD_CTX *mdctx = libcrypto.EVP_MD_CTX_new();
+    if (mdctx == nullptr) {
+      return std::string();
+    }
+    libcrypto.EVP_DigestInit_ex(mdctx, libcrypto.EVP_sha256(), nullptr);
+    libcrypto.EVP_DigestUpdate(mdctx, message, strlen(message));
+    libcrypto.EVP_DigestFinal_ex(mdctx, md_value, &md_len);
+    libcrypto.EVP_MD_CTX_free(mdctx);
+    return std::string(reinterpret_cast<char *>(md_value), md_len);
+  };
+  const std::string expected = sha256();
+  ASSERT_EQ(expected.size(), 32u);
+
+  const uint64_t generation = libcrypto.GetGeneration();
+  std::atomic<bool> stop{false};
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 4; t++) {
+    workers.emplace_back([&]() {
+      while (!stop.load()) {
+        if (sha256() != expected) {
+          mismatches++;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 20; i++) {
+    EXPECT_TRUE(i % 2 == 0 ? libcrypto.Reload() : libcrypto.ReloadEach());
+  }
+  stop = true;
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  EXPECT_EQ(mismatches.load(), 0);
+  // Each reload publishes one binding set, even with one SelfDlSym per
+  // function
+  EXPECT_EQ(libcrypto.GetGeneration(), generation + 20);
+  EXPECT_TRUE(libcrypto.CheckOk());
+  // Reloading does not grow the function cache
+  EXPECT_EQ(libcrypto.Size(), 8u);
+}
+
+// Pooled digest contexts are reused per thread instead of reallocated
+TEST(OpenSSLTest, PooledContexts) {
+  auto &libcrypto = LibCrypto::GetInstance();
+  const char *message = "Hello, OpenSSL Hashing!";
+
+  auto sha256 = [&libcrypto, message]() {
+    unsigned char md_value[EVP_MAX_MD_SIZE];
+    unsigned int md_len = 0;
+    auto mdctx = libcrypto.MdCtxPool.Acquire();
+    libcrypto.EVP_DigestInit_ex(mdctx.Get(), libcrypto.EVP_sha256(), nullptr);
+    libcrypto.EVP_DigestUpdate(mdctx.Get(), message, strlen(message));
+    libcrypto.EVP_DigestFinal_ex(mdctx.Get(), md_value, &md_len);
+    return std::make_pair(mdctx.Get(),
+                          std::string(reinterpret_cast<char *>(md_value),
+                                      md_len));
+  };
+
+  const auto first = sha256();
+  ASSERT_EQ(first.second.size(), 32u);
+  EXPECT_EQ(libcrypto.MdCtxPool.LocalFreeCount(), 1u);
+  for (int i = 0; i < 8; i++) {
+    const auto again = sha256();
+    EXPECT_EQ(again.first, first.first);
+    EXPECT_EQ(again.second, first.second);
+  }
+
+  // Another thread gets its own context, freed when the thread exits
+  EVP_MD_CTX *other = nullptr;
+  std::thread worker([&]() {
+    other = sha256().first;
+    EXPECT_EQ(libcrypto.MdCtxPool.LocalFreeCount(), 1u);
+  });
+  worker.join();
+  EXPECT_NE(other, first.first);
+  EXPECT_EQ(libcrypto.MdCtxPool.LocalFreeCount(), 1u);
+}
+
+// The wrapper can live in a registry instead of a function-local static
+TEST(OpenSSLTest, Registry) {
+  using Libraries = DlLibRegistry<LibCrypto>;
+  Libraries::Init();
+  auto &libcrypto = Libraries::Get<LibCrypto>();
+  EXPECT_NE(&libcrypto, &LibCrypto::GetInstance());
+  EXPECT_TRUE(libcrypto.CheckOk());
+  EXPECT_EQ(libcrypto.EVP_sha256.Get(),
+            LibCrypto::GetInstance().EVP_sha256.Get());
+
+  size_t listed = 0;
+  for (const auto &lib : GetLoadedLibraries()) {
+    if (lib.name == "libcrypto.so" && lib.boundSymbols == 8) {
+      EXPECT_TRUE(lib.missingSymbols.empty());
+      listed++;
+    }
+  }
+  EXPECT_GE(listed, 1u);
+  Libraries::Shutdown();
+}
+
 // Note: Removed the ErrorConditions test as calling OpenSSL functions with null pointers
 // can cause segfaults in the underlying library, which is not a fault of our wrapper.
 